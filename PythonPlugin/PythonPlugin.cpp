@@ -39,11 +39,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <float.h>
+#include <errno.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if TARGET_OS_MAC
+#include <mach/mach_time.h>
+#elif !TARGET_OS_WIN32
+#include <time.h>
+#endif
+
+#if !TARGET_OS_WIN32
+#include <unistd.h>
+#include <dlfcn.h>
+#else
+#include "Resource.h"
+#endif
 
 #if TARGET_OS_MAC
 #include <Python/Python.h>
-#else if TARGET_OS_WIN32
+#include <Python/pythread.h>
+#else
 #include <Python.h>
+#include <pythread.h>
 #endif
 
 // ---------------------------------------------------------------------------------
@@ -52,9 +71,45 @@
 
 #if PY_MAJOR_VERSION >= 3
 #define PyString_FromString PyUnicode_FromString
+#define PyString_FromStringAndSize PyUnicode_FromStringAndSize
 #define PyString_AsString PyUnicode_AsUTF8
 #define PyInt_FromLong PyLong_FromLong
 #define PyInt_AsLong PyLong_AsLong
+#define PyString_Check PyUnicode_Check
+#define PyString_Type PyUnicode_Type
+#define PyInt_Type PyLong_Type
+#define PyInt_Check PyLong_Check
+#endif
+
+// Dict items as strong references, which stay valid when another thread changes the
+// dict, as it can on the free-threaded build. Older versions only have borrowed ones.
+#if PY_VERSION_HEX < 0x030D0000
+static inline int
+PyDict_GetItemRef(
+	PyObject*	inDict,
+	PyObject*	inKey,
+	PyObject**	outItem)
+{
+	*outItem = PyDict_GetItem(inDict, inKey);
+	Py_XINCREF(*outItem);
+	return (*outItem != NULL) ? 1 : 0;
+}
+
+static inline int
+PyDict_GetItemStringRef(
+	PyObject*	inDict,
+	const char*	inKey,
+	PyObject**	outItem)
+{
+	*outItem = PyDict_GetItemString(inDict, (char*)inKey);
+	Py_XINCREF(*outItem);
+	return (*outItem != NULL) ? 1 : 0;
+}
+#endif
+
+// The code object flags are not part of the limited API
+#ifndef CO_GENERATOR
+#define CO_GENERATOR 0x0020
 #endif
 
 // ---------------------------------------------------------------------------------
@@ -105,6 +160,19 @@
 
 #endif
 
+// ---------------------------------------------------------------------------------
+// Other platforms
+// ---------------------------------------------------------------------------------
+// Allows the plugin to be compiled with GCC or Clang on other systems, against a
+// host that implements the Isadora callbacks.
+#if !TARGET_OS_MAC && !TARGET_OS_WIN32
+	#if defined(__GNUC__)
+	#define EXPORT_ __attribute__((visibility("default")))
+	#else
+	#define EXPORT_
+	#endif
+#endif
+
 // ---------------------------------------------------------------------------------
 //	Exported Function Definitions
 // ---------------------------------------------------------------------------------
@@ -132,22 +200,390 @@ ClearArgInputProperties(
 	IsadoraParameters*	ip,
 	ActorInfo*			inActorInfo);
 
+static void
+ReceiveMessage(
+	IsadoraParameters*	ip,
+	MessageMask			inMessageMask,
+	PluginMessageInfo*	inMessageInfo,
+	MessageRefCon		inRefCon);
+
+static void
+ReceiveSchedulerMessage(
+	IsadoraParameters*	ip,
+	MessageMask			inMessageMask,
+	PluginMessageInfo*	inMessageInfo,
+	MessageRefCon		inRefCon);
+
+static void
+DiscoverPythonFunc(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo);
+
+struct AsyncCall;
+struct PythonInterpreter;
+
+static void
+StopAsyncWorker(
+	PythonInterpreter*	interp);
+
+static AsyncCall*
+NewAsyncCall();
+
+static void
+LockAsyncCall(
+	AsyncCall*			call);
+
+static void
+UnlockAsyncCall(
+	AsyncCall*			call);
+
+static void
+ReleaseAsyncCall(
+	AsyncCall*			call);
+
+struct ArgValue;
+
+static void
+FreeArgValues(
+	ArgValue*			args,
+	unsigned int		numArgs);
+
+static ArgValue*
+CopyArgValues(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	unsigned int		inNumArgs);
+
+static char*
+FetchPythonError();
+
+static void
+OutputPythonError(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	const char*			inError);
+
 
 // ---------------------------------------------------------------------------------
 // GLOBAL VARIABLES
 // ---------------------------------------------------------------------------------
 // Declare global variables, common to all instantiations of this plugin here
 
+// The embedded python interpreter is shared by all instances of the plugin. It is
+// initialized when the first actor is created, and finalized when the last actor
+// is disposed. Between calls the GIL is released, so any thread can enter the
+// interpreter using PyGILState_Ensure/PyGILState_Release.
+static unsigned int		sInterpreterRefCount = 0;
+static bool				sInterpreterOwned = false;
+static PyThreadState*	sMainThreadState = NULL;
+
+// All interpreters in use; the main interpreter first, followed by the
+// sub-interpreters of actor groups.
+static PythonInterpreter*	sInterpreters = NULL;
+
+// Protects the deadlines of running calls. The worker queues and AsyncCall structs
+// have locks of their own, so calls without a time limit never take it.
+static PyThread_type_lock	sDeadlineLock = NULL;
+
+// The number of worker threads of each interpreter, from CountAsyncWorkers.
+static unsigned int			sNumAsyncWorkers = 1;
+
+// Calls with a time limit, in the order in which they started, and the watchdog
+// thread that interrupts them. The watchdog is started by the first call with a
+// time limit, and waits on sWatchdogSignal while there are no deadlines.
+struct Deadline;
+static Deadline*			sDeadlines = NULL;
+static PyThread_type_lock	sWatchdogSignal = NULL;
+static PyThread_type_lock	sWatchdogDone = NULL;
+static bool					sWatchdogSignaled = false;
+static bool					sWatchdogStarted = false;
+static bool					sWatchdogStop = false;
+
+// All actors, in the order in which they were created. Batched calls are run in
+// this order by a single receiver of the video frame clock, which exists while any
+// actor is active.
+static ActorInfo**			sActors = NULL;
+static unsigned int			sNumActors = 0;
+static unsigned int			sNumActiveActors = 0;
+static MessageReceiverRef	sSchedulerReceiver = NULL;
+
+// The arguments of recently discovered functions, most recently used first. Actors
+// using the same function share the result, until its source files change.
+struct DiscoveredFunc;
+static DiscoveredFunc*		sDiscoveredFuncs = NULL;
+
+// The recent trace events of all actors and threads, in a ring buffer that is
+// written without locking. sTraceNext counts the events recorded so far. The buffer
+// exists while there are actors.
+struct TraceEvent;
+static TraceEvent*				sTraceEvents = NULL;
+static volatile unsigned long	sTraceNext = 0;
+
+// ---------------------------------------------------------------------------------
+// ValueConverter
+// ---------------------------------------------------------------------------------
+// Converts an Isadora value, with its string data passed separately, to a new
+// python object.
+
+typedef PyObject* (*ValueConverter)(const Value* inValue, const char* inString);
 
 // ---------------------------------------------------------------------------------
 // Property struct
 // ---------------------------------------------------------------------------------
-// This structure is used to store property names, types and values in the
-// PluginInfo struct.
+// This structure is used to store the names, types and default values of the
+// arguments of the function in the PluginInfo struct. The arguments of an actor
+// are stored in a single block, followed by their names.
 
 struct Property {
-	char*				name;		// display name of the property
-	Value*				value;		// contains type and data
+	char*				name;		// display name of the property, in the same block
+	Value				value;		// contains type and data
+	ValueConverter		convert;	// converts values of this type to python
+	bool				dirty;		// set when the input changes, until it is converted again
+};
+
+// ---------------------------------------------------------------------------------
+// WatchedFile struct
+// ---------------------------------------------------------------------------------
+// This structure is used to store the modification time and size of the source
+// files of a loaded module, so changes to the files can be detected.
+
+struct WatchedFile {
+	char*				path;		// full path of the source file
+	time_t				mtime;		// modification time when the module was loaded
+	off_t				size;		// file size when the module was loaded
+};
+
+// ---------------------------------------------------------------------------------
+// ArgValue struct
+// ---------------------------------------------------------------------------------
+// This structure is used to store a copy of an argument input value, so it can be
+// passed to python on another thread.
+
+struct ArgValue {
+	Value				value;		// type and numeric data of the argument
+	char*				str;		// copy of the string data for string arguments
+	bool				present;	// false if the actor has no input for the argument
+};
+
+// ---------------------------------------------------------------------------------
+// PythonResult struct
+// ---------------------------------------------------------------------------------
+// This structure is used to store the converted return value of a call until it is
+// sent to the outputs of the actor. Tuple and dict return values are stored as a
+// list of items, one for each element.
+
+enum ResultKind {
+	kResultSingle,					// a single value, converted to the result type
+	kResultTuple,					// a tuple, with an output per element
+	kResultDict						// a dict, with an output per key
+};
+
+// How the function is called. Generator functions and classes keep their state
+// between the calls of an actor.
+
+enum FuncKind {
+	kFuncPlain,						// called on each trigger
+	kFuncGenerator,					// started on the first trigger, the arguments are sent to it after that
+	kFuncClass,						// instantiated on the first trigger, the instance is called after that
+	kFuncCode,						// inline code, evaluated with the arguments as its global variables
+	kFuncProcess					// a WorkerProcess, called on each trigger
+};
+
+struct PythonResult {
+	Value				value;		// type and numeric data of the result
+	char*				str;		// string data for string results, allocated with malloc
+	char*				key;		// key of a dict item
+	PythonResult*		items;		// elements of a tuple or dict, or NULL
+	unsigned int		numItems;
+};
+
+// ---------------------------------------------------------------------------------
+// ValueOutput struct
+// ---------------------------------------------------------------------------------
+// This structure is used to describe an output added for the return value.
+
+struct ValueOutput {
+	char*				name;		// name of the output, and the key of dict results
+	ValueType			type;
+};
+
+// ---------------------------------------------------------------------------------
+// AsyncCall struct
+// ---------------------------------------------------------------------------------
+// This structure is shared between an actor and the worker thread that executes
+// its asynchronous calls. Only the latest queued arguments are kept, so a backlog
+// of calls can not build up. It is freed when both the actor and the worker are
+// done with it. Each actor has its own dataLock, so triggers and results of
+// different actors don't wait for each other. When both are needed, dataLock is
+// acquired before the queueLock of the interpreter.
+
+struct AsyncCall {
+	// protected by dataLock
+	PyThread_type_lock	dataLock;
+	unsigned int		refCount;	// one for the actor, one while queued or running
+	bool				disposed;	// set when the actor is disposed
+	bool				pending;	// args holds arguments that have not been taken yet
+	ArgValue*			args;		// latest arguments, or NULL
+	unsigned int		numArgs;
+	ResultKind			resultKind;	// kind and type to convert the return value to
+	ValueType			resultType;
+	bool				hasResult;	// a result is waiting to be delivered to the outputs
+	PythonResult		result;		// converted return value
+	char*				error;		// error string, or NULL if the call succeeded
+	double				gilWait;	// timing of the call, in milliseconds
+	double				python;
+	double				busy;
+	SInt32				timeout;	// time limit of the call in milliseconds, 0 for none
+	bool				map;		// the first argument is a list to call the function for
+	ValueType			mapType;
+	char				separator[8];
+	unsigned int		overruns;	// calls that took longer than the time limit
+	const void*			actor;		// for trace events
+	char				funcName[32];
+	
+	// protected by the queueLock of the interpreter
+	bool				queued;		// waiting in the worker queue
+	bool				running;	// being executed by a worker
+	AsyncCall*			next;		// next call in the worker queue
+	
+	// only accessed with the GIL held and callLock acquired by LockAsyncCall, so calls
+	// of one actor never run at the same time, even without a GIL
+	PyThread_type_lock	callLock;
+	PyObject*			func;		// strong reference to the function to call
+	PyObject*			kwNames;	// names of the keyword-only arguments, or NULL
+	FuncKind			funcKind;
+	PyObject*			state;		// generator, instance or globals of the function, shared with the synchronous calls
+};
+
+// ---------------------------------------------------------------------------------
+// ResultCache struct
+// ---------------------------------------------------------------------------------
+// This structure holds the results of recent calls of an actor, keyed by their
+// argument values, so pure functions don't have to be called again for arguments
+// they have seen before. The entries are kept in a hash table, and in a list from
+// the most to the least recently used.
+
+struct CacheEntry {
+	UInt32				hash;			// hash of the argument values
+	ArgValue*			args;			// copy of the argument values
+	unsigned int		numArgs;
+	PythonResult		result;
+	CacheEntry*			nextInBucket;
+	CacheEntry*			newer;			// LRU list
+	CacheEntry*			older;
+};
+
+struct ResultCache {
+	unsigned int		size;			// maximum number of entries, 0 if the cache is off
+	unsigned int		count;
+	CacheEntry**		buckets;		// numBuckets chains, allocated with the first entry
+	unsigned int		numBuckets;		// a power of two
+	CacheEntry*			newest;
+	CacheEntry*			oldest;
+	UInt32				hits;
+	UInt32				misses;
+};
+
+// ---------------------------------------------------------------------------------
+// CallStats struct
+// ---------------------------------------------------------------------------------
+// This structure holds the timing of the calls of an actor, for the statistics
+// outputs. Durations are in milliseconds.
+
+struct CallStats {
+	double				gilWait;		// of the call in progress
+	double				python;			// time spent in the function itself
+	double				busy;			// time spent on a batched call before its output
+	double				average;		// exponential moving average of the call duration
+	double				max;
+	double				rateStart;		// start of the calls per second period, in seconds
+	UInt32				rateCalls;		// calls in the current period
+};
+
+// ---------------------------------------------------------------------------------
+// TraceEvent struct
+// ---------------------------------------------------------------------------------
+// This structure describes a stage of a call, or of looking up a function, for the
+// trace file. The sequence number is written last, so events that are being written
+// can be recognized.
+
+struct TraceEvent {
+	volatile unsigned long	seq;		// number of the event plus one, or 0 while it is written
+	const char*			stage;			// a string constant
+	const void*			actor;
+	unsigned long		thread;
+	double				start;			// in seconds, on the GetSeconds clock
+	double				end;
+	char				func[32];		// name of the function
+};
+
+// ---------------------------------------------------------------------------------
+// DiscoveredFunc struct
+// ---------------------------------------------------------------------------------
+// This structure holds the arguments discovered for a function, so the function
+// does not have to be inspected again for every actor that uses it. An entry is
+// only used while the source files of the module are unchanged.
+
+struct DiscoveredFunc {
+	char*				path;			// the path, module and function inputs
+	char*				file;
+	char*				func;
+	WatchedFile*		files;			// source files of the module when it was inspected
+	unsigned int		numFiles;
+	char**				argNames;
+	ArgValue*			args;			// types and default values of the arguments
+	unsigned int		numArgs;
+	unsigned int		numKeywordArgs;
+	DiscoveredFunc*		next;
+};
+
+// ---------------------------------------------------------------------------------
+// PythonInterpreter struct
+// ---------------------------------------------------------------------------------
+// This structure describes the main interpreter, or a sub-interpreter shared by a
+// group of actors, and the worker thread that executes asynchronous calls in it.
+// Each sub-interpreter has its own GIL, so the workers of different interpreters
+// run in parallel. The worker waits on workerSignal, which is locked whenever
+// workerSignaled is false.
+
+struct PythonInterpreter {
+	SInt32				group;			// the actor group, 0 for the main interpreter
+	unsigned int		refCount;		// number of actors using the interpreter
+	PyInterpreterState*	state;
+	PyThreadState*		threadState;	// thread state of the main thread in a sub-interpreter,
+										// NULL for the main interpreter
+	PythonInterpreter*	next;
+	
+	// protected by queueLock
+	PyThread_type_lock	queueLock;
+	PyThread_type_lock	workerSignal;	// released to wake up a worker
+	PyThread_type_lock	workerDone;		// released when the last worker exits
+	bool				workerSignaled;
+	bool				workerStop;
+	unsigned int		numWorkers;		// worker threads running
+	AsyncCall*			queueHead;		// calls waiting to be executed
+	AsyncCall*			queueTail;
+};
+
+// ---------------------------------------------------------------------------------
+// Deadline struct
+// ---------------------------------------------------------------------------------
+// A running call with a time limit. The struct lives on the stack of the thread that
+// makes the call, and is in the sDeadlines list while the call runs. When the time
+// is up, the watchdog thread raises a TimeoutError in the calling thread, and raises
+// it again after every further time limit, in case the function caught it. A call in
+// a worker process is not interrupted; the process is killed instead.
+
+struct Deadline {
+	// protected by sDeadlineLock
+	double				time;		// end of the time limit in seconds, or 0 if there is none
+	double				interval;	// the time limit in seconds
+	unsigned long		thread;		// identifier of the calling thread
+	PythonInterpreter*	interp;		// the interpreter the call runs in
+	PyObject*			worker;		// the WorkerProcess that is called, which is killed instead
+	bool				firing;		// the watchdog is raising the exception
+	bool				fired;		// the exception has been raised at least once
+	Deadline*			next;
 };
 
 // ---------------------------------------------------------------------------------
@@ -166,11 +602,83 @@ typedef struct {
 	char*				mPath;
 	char*				mFile;
 	char*				mFunc;
+	char*				mCode;				// inline code, used instead of the function if not empty
 	
 	unsigned int		mNumArgs;
+	unsigned int		mNumKeywordArgs;	// the last arguments are keyword-only
 	bool				mFuncFound;
+	unsigned int		mDiscoveryTicks;	// counts down while a changed path, module or function settles
 
-	Property**			mArgs;
+	Property*			mArgs;				// mNumArgs arguments, followed by their names
+	size_t				mArgsSize;			// allocated size of mArgs, reused by the next discovery
+	
+	// strong references to the resolved module and function, kept between calls
+	PyObject*			mPyModule;
+	PyObject*			mPyFunc;
+	FuncKind			mFuncKind;			// the state of generators and classes is kept in mAsyncCall
+	bool				mStateful;			// calls keep state between them, so results are not cached
+	
+	// the arguments of the last call, reused for the arguments that did not change
+	PyObject*			mArgTuple;
+	PyObject*			mKwNames;			// names of the keyword-only arguments, or NULL
+	UInt32				mArgTupleInputs;	// number of argument inputs when it was created
+	
+	// source files of the module, checked for changes on the video frame clock
+	bool				mAutoReload;
+	WatchedFile*		mWatchedFiles;
+	unsigned int		mNumWatchedFiles;
+	unsigned int		mWatchTicks;
+	
+	// the interpreter the module is loaded in
+	PythonInterpreter*	mInterpreter;
+	
+	// calls sent to a worker process instead of the embedded interpreter
+	bool				mProcess;
+	
+	// calls executed on the worker thread
+	bool				mAsync;
+	AsyncCall*			mAsyncCall;
+	
+	// results of recent calls, for functions without side effects
+	ResultCache			mCache;
+	
+	// calls for each value of a list in the first argument, with the results joined
+	bool				mMap;
+	ValueType			mMapType;			// type of the values, from the first argument
+	char				mSeparator[8];
+	
+	// results pulled one at a time from an iterator over the return value
+	SInt32				mStreamMode;		// the stream input
+	PyObject*			mStream;			// the iterator, or NULL
+	
+	// time limit of a call in milliseconds, 0 for none
+	SInt32				mTimeout;
+	unsigned int		mOverruns;			// calls that took longer than the time limit
+	
+	// timing of the calls, sent to the statistics outputs
+	bool				mStatsOn;
+	CallStats			mStats;
+	
+	// calls executed once per video frame, together with other actors
+	bool				mBatch;
+	bool				mBatchPending;
+	bool				mBatchDone;
+	PythonResult		mBatchResult;
+	char*				mBatchError;
+	
+	// type of the return value
+	SInt32				mOutputType;		// the output_type input
+	ResultKind			mAnnotatedKind;		// from the return annotation
+	ValueType			mAnnotatedType;		// for single values, kString if there is no annotation
+	ValueOutput*		mAnnotatedOutputs;	// for tuples and dicts
+	unsigned int		mNumAnnotatedOutputs;
+	ResultKind			mResultKind;		// how return values are converted
+	ValueType			mResultType;
+	ValueOutput*		mValueOutputs;		// the outputs after the fixed outputs
+	unsigned int		mNumValueOutputs;
+	bool				mValueOutputsKnown;
+	
+	MessageReceiverRef	mMessageReceiver;
 } PluginInfo;
 
 // A handy macro for casting the mActorDataPtr to PluginInfo*
@@ -205,6 +713,39 @@ static const OSType	kActorID		= FOUR_CHAR_CODE('zPyP');
 
 static const char* kActorName		= "PythonPlugin";
 
+// WATCH INTERVAL
+// The number of video frame clock ticks between checks for changed module files.
+
+static const unsigned int kWatchIntervalTicks = 30;
+
+// DISCOVERY DELAY
+// The number of video frame clock ticks the path, module and function inputs must
+// remain unchanged before the function is looked up, so names are not imported
+// while they are being typed.
+
+static const unsigned int kDiscoveryDelayTicks = 10;
+
+// DISCOVERY CACHE SIZE
+// The maximum number of discovered functions that are remembered.
+
+static const unsigned int kMaxDiscoveredFuncs = 64;
+
+// TRACE BUFFER SIZE
+// The number of recent trace events that are kept. Must be a power of two.
+
+static const unsigned int kTraceBufferSize = 16384;
+
+// MAXIMUM ASYNC WORKERS
+// The maximum number of worker threads of an interpreter.
+
+static const unsigned int kMaxAsyncWorkers = 64;
+
+// WORKER PROCESS START TIMEOUT
+// The number of seconds a worker process may take to import the module and report
+// its function, before it is stopped.
+
+static const double kWorkerStartSeconds = 30.0;
+
 // PROPERTY DEFINITION STRING
 // The property string. This string determines the inputs and outputs for your plugin.
 // See the IsadoraCallbacks.h under the heading "PROPERTY DEFINITION STRING" for the
@@ -227,13 +768,39 @@ static const char* sPropertyDefinitionString =
 	"INPROP		module			file	string		text				*		*		\r"
 	"INPROP		function		func	string		text				*		*		\r"
 	"INPROP		get_args		parm	bool		trig				0		1		0\r"
+	"INPROP		auto_reload		arld	bool		onoff				0		1		1\r"
+	"INPROP		async			asyn	bool		onoff				0		1		0\r"
+	"INPROP		interpreter		intp	int			number				0		99		0\r"
+	"INPROP		batch			btch	bool		onoff				0		1		0\r"
+	"INPROP		output_type		otyp	int			number				0		4		0\r"
+	"INPROP		cache			cach	int			number				0		1024	0\r"
+	"INPROP		stats			stat	bool		onoff				0		1		0\r"
+	"INPROP		write_trace		wtrc	bool		trig				0		1		0\r"
+	"INPROP		code			code	string		text				*		*		\r"
+	"INPROP		process			proc	bool		onoff				0		1		0\r"
+	"INPROP		timeout_ms		tout	int			number				0		*		0\r"
+	"INPROP		stream			strm	int			number				0		2		0\r"
+	"INPROP		next			next	bool		trig				0		1		0\r"
+	"INPROP		map				map		bool		onoff				0		1		0\r"
+	"INPROP		separator		sepr	string		text				*		*		\r"
 
 // OUTPUT PROPERTY DEFINITIONS
 //	TYPE 		PROPERTY NAME	ID		DATATYPE	DISPLAY FMT			MIN		MAX		INIT VALUE
 	"OUTPROP 	function_found	fnd		bool		onoff				0		1		0\r"
 	"OUTPROP 	function_ran	ran		bool		trig				0		1		0\r"
 	"OUTPROP	error			err		string		text				*		*		\r"
-	"OUTPROP	output			out		string		text				*		*		\r";
+	"OUTPROP	output			out		string		text				*		*		\r"
+	"OUTPROP	reloaded		rld		bool		trig				0		1		0\r"
+	"OUTPROP	cache_hits		chit	int			number				0		*		0\r"
+	"OUTPROP	cache_misses	cmis	int			number				0		*		0\r"
+	"OUTPROP	call_ms			ctim	float		number				0		*		0\r"
+	"OUTPROP	average_ms		catm	float		number				0		*		0\r"
+	"OUTPROP	max_ms			cmax	float		number				0		*		0\r"
+	"OUTPROP	calls_per_sec	crat	float		number				0		*		0\r"
+	"OUTPROP	gil_wait_ms		cgil	float		number				0		*		0\r"
+	"OUTPROP	convert_ms		ccnv	float		number				0		*		0\r"
+	"OUTPROP	overruns		ovrn	int			number				0		*		0\r"
+	"OUTPROP	exhausted		exh		bool		trig				0		1		0\r";
 
 // Property Index Constants
 // Properties are referenced by a one-based index. The first input property will
@@ -248,14 +815,50 @@ enum
 	kInputFile,
 	kInputFunc,
 	kInputGetArgs,
+	kInputAutoReload,
+	kInputAsync,
+	kInputInterpreter,
+	kInputBatch,
+	kInputOutputType,
+	kInputCache,
+	kInputStats,
+	kInputWriteTrace,
+	kInputCode,
+	kInputProcess,
+	kInputTimeout,
+	kInputStream,
+	kInputNext,
+	kInputMap,
+	kInputSeparator,
 	kInputArg0,
 	
 	kOutputFuncFound = 1,
 	kOutputTrigger,
 	kOutputError,
-	kOutputResult
+	kOutputResult,
+	kOutputReloaded,
+	kOutputCacheHits,
+	kOutputCacheMisses,
+	kOutputCallTime,
+	kOutputAverageTime,
+	kOutputMaxTime,
+	kOutputCallRate,
+	kOutputGILWait,
+	kOutputConvertTime,
+	kOutputOverruns,
+	kOutputExhausted,
+	kOutputValue
 };
 
+// ARGUMENT PROPERTY IDS
+// The property IDs of the argument inputs and the value outputs are numbered from
+// these, which were the indexes of the first argument input and value output before
+// more fixed inputs and outputs were added. Scenes saved with earlier versions of the
+// plugin refer to the inputs and outputs by these IDs.
+
+static const SInt32 kArg0PropertyID = 6;
+static const SInt32 kValue0PropertyID = 6;
+
 
 // ---------------------
 //	Help String
@@ -286,6 +889,36 @@ const char* sHelpStrings[] =
 	
 	"When triggered, inputs are added for each argument of the python function.",
 	
+	"When on, the python module is reloaded when its source files change.",
+	
+	"When on, the function is executed on a separate thread, and its result is output on a later frame. If the actor is triggered again before the function ran, only the latest arguments are used.",
+	
+	"Actors with the same non-zero number share a separate python interpreter with its own GIL, so asynchronous calls of different groups run in parallel. Requires Python 3.12 or newer; otherwise all actors use the main interpreter.",
+	
+	"When on, triggering the actor calls the function on the next video frame, together with all other actors in batch mode. Multiple triggers within one frame result in a single call.",
+	
+	"Type of the return value. 0 uses the return annotation of the function, 1 is text, 2 integer, 3 float and 4 boolean. Numbers and booleans are sent to the value output, without converting them to text.",
+	
+	"Number of results to keep for functions that always return the same result for the same arguments. When a result for the current arguments is kept, it is output without calling python. 0 turns the cache off.",
+	
+	"When on, the duration of each call is measured and sent to the statistics outputs.",
+	
+	"When triggered, the recent calls of all actors are written to a trace file that can be opened in chrome://tracing or Perfetto. The file is named by the IZZY_PYTHON_TRACE environment variable, or izzy_python_trace.json in the temporary folder.",
+	
+	"Python code to run instead of a function: an expression, or statements that assign the result to a variable named result. Names the code uses without defining them become arguments.",
+	
+	"When on, the function runs in a separate python process, so a crash does not take down Isadora, and a call that hangs can be stopped with timeout_ms, which kills the process. The process imports the module and reports the arguments of the function when it is looked up, and is started again by the next call after it stopped. Calls run one at a time; with async on, IZZY_PYTHON_WORKERS sets how many processes can work at once.",
+	
+	"Time limit of a call in milliseconds. A call that takes longer is interrupted with a TimeoutError, which is shown on the error output. Code waiting outside of python, such as in time.sleep, is not interrupted, but a worker process of the process input is killed. 0 turns the limit off.",
+	
+	"When not 0, triggering the actor starts a stream of results: a generator function is started, and the elements of other return values are iterated over. 1 outputs the next result on every video frame, 2 outputs it when the next input is triggered.",
+	
+	"Outputs the next result of the stream.",
+	
+	"When on, the first argument is a list of values separated by the separator. The function is called for each value, and the results are joined into a single text on the output. Trigger get_args after turning it on, to get a text input for the list.",
+	
+	"Separates the values of the list in map mode, and the results on the output. A comma if empty.",
+	
 	"Argument for the python function.",
 	
 	"Set to 'on' if the specified python function was found.",
@@ -295,569 +928,5007 @@ const char* sHelpStrings[] =
 	"Outputs any error string returned by the python function. ",
 	
 	"Outputs data returned by the python function. ",
+	
+	"Triggered when the python module has been reloaded because its source files changed.",
+	
+	"Number of calls answered from the cache.",
+	
+	"Number of calls that were not in the cache, and called the python function.",
+	
+	"Duration of the last call in milliseconds, from the trigger until the result was output. Only measured while the stats input is on.",
+	
+	"Moving average of the call duration in milliseconds.",
+	
+	"Longest call duration in milliseconds since the stats input was turned on.",
+	
+	"Number of calls per second.",
+	
+	"Time the last call waited for the python interpreter (the GIL) in milliseconds.",
+	
+	"Time the last call spent converting the arguments and the return value in milliseconds, excluding the python function itself.",
+	
+	"Number of calls that took longer than the time limit, since it was set.",
+	
+	"Triggered when the stream has no more results.",
+	
+	"Outputs the return value of the python function as a number or boolean.",
 };
 
 // ---------------------------------------------------------------------------------
-//		 CreateActor
+//		 GetSeconds
 // ---------------------------------------------------------------------------------
-// Called once, prior to the first activation of an actor in its Scene. The
-// corresponding DisposeActor actor function will not be called until the file
-// owning this actor is closed, or the actor is destroyed as a result of being
-// cut or deleted.
+// Returns the time in seconds on a monotonic high resolution clock.
 
-static void
-CreateActor(
-	IsadoraParameters*	ip,	
-	ActorInfo*			ioActorInfo)		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
+static double
+GetSeconds()
 {
-	// create the PluginInfo struct - initializing it to all zeroes
-	PluginInfo* info = (PluginInfo*) IzzyMallocClear_(ip, sizeof(PluginInfo));
-	PluginAssert_(ip, info != nil);
+#if TARGET_OS_WIN32
+	static LARGE_INTEGER frequency;
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
 	
-	ioActorInfo->mActorDataPtr = info;
-	info->mActorInfoPtr = ioActorInfo;
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#elif TARGET_OS_MAC
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0)
+		mach_timebase_info(&timebase);
 	
-	info->mNumArgs = 0;
-	info->mFuncFound = false;
-	info->mArgs = NULL;
+	return (double)mach_absolute_time() * timebase.numer / timebase.denom * 1e-9;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
 }
 
 // ---------------------------------------------------------------------------------
-//		 DisposeActor
+//		 RecordTraceEvent
 // ---------------------------------------------------------------------------------
-// Called when the file owning this actor is closed, or when the actor is destroyed
-// as a result of its being cut or deleted.
-//
+// Adds a stage of a call to the trace buffer, overwriting the oldest event when the
+// buffer is full. Can be called from any thread, with or without the GIL.
+
 static void
-DisposeActor(
-	IsadoraParameters*	ip,
-	ActorInfo*			ioActorInfo)		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
+RecordTraceEvent(
+	const char*	inStage,
+	const void*	inActor,
+	const char*	inFunc,
+	double		inStart,
+	double		inEnd)
 {
-	PluginInfo* info = GetPluginInfo_(ioActorInfo);
-	PluginAssert_(ip, info != nil);
+	if (sTraceEvents == NULL)
+		return;
 	
-	// destruction of private member variables
-	if (info->mPath != NULL)
-		free(info->mPath);
-	if (info->mFile != NULL)
-		free(info->mFile);
-	if (info->mFunc != NULL)
-		free(info->mFunc);
+#if TARGET_OS_WIN32
+	unsigned long seq = (unsigned long) InterlockedIncrement((volatile LONG*) &sTraceNext);
+#else
+	unsigned long seq = __sync_add_and_fetch(&sTraceNext, 1);
+#endif
+	TraceEvent *event = &sTraceEvents[(seq - 1) & (kTraceBufferSize - 1)];
+	event->seq = 0;
 	
-	if (info->mArgs != NULL)
+	event->stage = inStage;
+	event->actor = inActor;
+	event->thread = PyThread_get_thread_ident();
+	event->start = inStart;
+	event->end = inEnd;
+	
+	// only characters that need no escaping in the trace file
+	unsigned int i = 0;
+	if (inFunc != NULL)
 	{
-		int i, size;
-		size = info->mNumArgs;
-		for (i=0; i<size; i++)
+		for (; *inFunc != 0 && i < sizeof(event->func) - 1; inFunc++)
 		{
-			free(info->mArgs[i]->name);
-			if (info->mArgs[i]->value->type == kString)
-			{
-				ReleaseValueString_(ip, info->mArgs[i]->value);
-			}
-			free(info->mArgs[i]->value);
-			free(info->mArgs[i]);
+			char c = *inFunc;
+			if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.')
+				event->func[i++] = c;
 		}
-		free(info->mArgs);
 	}
+	event->func[i] = 0;
 	
-	// destroy the PluginInfo struct allocated with IzzyMallocClear_ the CreateActor function
-	PluginAssert_(ip, ioActorInfo->mActorDataPtr != nil);
-	IzzyFree_(ip, ioActorInfo->mActorDataPtr);
+#if TARGET_OS_WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+	event->seq = seq;
 }
 
 // ---------------------------------------------------------------------------------
-//		 ActivateActor
+//		 GetTracePath
 // ---------------------------------------------------------------------------------
-//	Called when the scene that owns this actor is activated or deactivated. The
-//	inActivate flag will be true when the scene is activated, false when deactivated.
-//
+// Returns the path of the trace file: the IZZY_PYTHON_TRACE environment variable,
+// or izzy_python_trace.json in the temporary folder.
+
 static void
-ActivateActor(
-	IsadoraParameters*	ip,
-	ActorInfo*			inActorInfo,		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
-	Boolean				inActivate)			// true when actor is becoming active, false otherwise.
+GetTracePath(
+	char*	outPath,
+	size_t	inSize)
 {
-	PluginInfo* info = GetPluginInfo_(inActorInfo);
-	
-	// ------------------------
-	// ACTIVATE
-	// ------------------------
-	if (inActivate)
+	const char *path = getenv("IZZY_PYTHON_TRACE");
+	if (path != NULL && path[0] != 0)
 	{
+		snprintf(outPath, inSize, "%s", path);
+		return;
+	}
 	
-		// Isadora passes various messages to plugins that request them.
-		// These include Mouse Moved messages, Key Down/Key Up messages,
-		// Video Frame Clock messages, etc. The complete list can be found
-		// in the enumeration in MessageReceiverCommon.h
+#if TARGET_OS_WIN32
+	const char *dir = getenv("TEMP");
+	const char *separator = "\\";
+	if (dir == NULL || dir[0] == 0)
+		dir = ".";
+#else
+	const char *dir = getenv("TMPDIR");
+	const char *separator = "/";
+	if (dir == NULL || dir[0] == 0)
+		dir = "/tmp";
+#endif
+	snprintf(outPath, inSize, "%s%s%s", dir, separator, "izzy_python_trace.json");
+}
+
+// ---------------------------------------------------------------------------------
+//		 WriteTraceFile
+// ---------------------------------------------------------------------------------
+// Writes the events in the trace buffer to a file in the chrome trace event format.
+// Events are copied one at a time while other threads keep recording; events that
+// are overwritten while they are copied are left out. Returns false if the file
+// could not be written.
+
+static bool
+WriteTraceFile(
+	const char*	inPath)
+{
+	if (sTraceEvents == NULL)
+		return false;
+	
+	FILE *file = fopen(inPath, "w");
+	if (file == NULL)
+		return false;
+	
+	unsigned long last = sTraceNext;
+	unsigned long first = (last > kTraceBufferSize) ? last - kTraceBufferSize : 0;
+	
+	fprintf(file, "{\"traceEvents\":[");
+	bool separate = false;
+	unsigned long n;
+	for (n=first; n!=last; n++)
+	{
+		const TraceEvent *slot = &sTraceEvents[n & (kTraceBufferSize - 1)];
+		if (slot->seq != n + 1)
+			continue;
 		
-		// You ask Isadora for these messages by calling CreateMessageReceiver_
-		// with a pointer to your function, and the message types you would
-		// like to receive. (These are bitmapped flags, so you can combine as
-		// many as you like: kWantKeyDown | kWantKeyDown for instance.)
+		TraceEvent event = *slot;
+		if (slot->seq != n + 1 || event.seq != n + 1)
+			continue;
+		event.func[sizeof(event.func) - 1] = 0;
 		
+		fprintf(file, "%s\n{\"name\":\"%s %s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%lu,\"args\":{\"actor\":\"%p\",\"function\":\"%s\"}}",
+				separate ? "," : "", event.stage, event.func, event.stage, event.start * 1e6, (event.end - event.start) * 1e6,
+				event.thread, event.actor, event.func);
+		separate = true;
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
 	
-	// ------------------------
-	// DEACTIVATE
-	// ------------------------
+	return (fclose(file) == 0);
+}
+
+// ---------------------------------------------------------------------------------
+//		 CountAsyncWorkers
+// ---------------------------------------------------------------------------------
+// Returns the number of worker threads each interpreter uses for asynchronous calls.
+// While the GIL is enabled only one call can run at a time, so one worker is enough.
+// A free-threaded python (3.13 or newer, with the GIL disabled) gets a worker for
+// each processor, so the calls of different actors run in parallel. The
+// IZZY_PYTHON_WORKERS environment variable overrides the number. Must be called with
+// the GIL held.
+
+static unsigned int
+CountAsyncWorkers()
+{
+	const char *env = getenv("IZZY_PYTHON_WORKERS");
+	long count = (env != NULL) ? atol(env) : 0;
+	
+	if (count <= 0)
+	{
+		PyObject *pEnabled = PySys_GetObject((char*)"_is_gil_enabled");	// borrowed
+		PyObject *pGIL = (pEnabled != NULL) ? PyObject_CallObject(pEnabled, NULL) : NULL;
+		if (pGIL == Py_False)
+		{
+			PyObject *pOs = PyImport_ImportModule("os");
+			PyObject *pCount = (pOs != NULL) ? PyObject_CallMethod(pOs, "cpu_count", NULL) : NULL;
+			count = (pCount != NULL && PyInt_Check(pCount)) ? PyInt_AsLong(pCount) : 1;
+			Py_XDECREF(pCount);
+			Py_XDECREF(pOs);
+		}
+		Py_XDECREF(pGIL);
+		PyErr_Clear();
+	}
 	
+	if (count < 1)
+		count = 1;
+	if (count > (long)kMaxAsyncWorkers)
+		count = kMaxAsyncWorkers;
+	return (unsigned int)count;
+}
+
+// ---------------------------------------------------------------------------------
+//		 SleepMilliseconds
+// ---------------------------------------------------------------------------------
+
+static void
+SleepMilliseconds(
+	unsigned int	inMilliseconds)
+{
+#if TARGET_OS_WIN32
+	Sleep(inMilliseconds);
+#else
+	usleep(inMilliseconds * 1000);
+#endif
+}
+
+// ---------------------------------------------------------------------------------
+//		 InterruptCall
+// ---------------------------------------------------------------------------------
+// Interrupts the call of a deadline. If the call is running python code, a
+// TimeoutError is raised in its thread as soon as it executes the next python
+// instruction. If it is waiting for a worker process, the process is killed, so the
+// call fails; an exception raised in the middle of the subprocess module could leave
+// its locks held. Must be called without holding the GIL.
+
+static void
+InterruptCall(
+	Deadline*	deadline)
+{
+#if PY_MAJOR_VERSION >= 3
+	PyObject *pException = PyExc_TimeoutError;
+#else
+	PyObject *pException = PyExc_RuntimeError;
+#endif
+
+	// PyThreadState_SetAsyncExc only finds threads of the current interpreter
+	PythonInterpreter *interp = deadline->interp;
+	PyGILState_STATE gstate = PyGILState_UNLOCKED;
+	PyThreadState *threadState = NULL;
+	if (interp->threadState == NULL)
+	{
+		gstate = PyGILState_Ensure();
 	}
 	else
 	{
-	
+		threadState = PyThreadState_New(interp->state);
+		PyEval_RestoreThread(threadState);
+	}
+
+	if (deadline->worker != NULL)
+	{
+		PyObject *pResult = PyObject_CallMethod(deadline->worker, "kill", NULL);
+		Py_XDECREF(pResult);
+		PyErr_Clear();
+	}
+	else
+	{
+		PyThreadState_SetAsyncExc(deadline->thread, pException);
+	}
+
+	if (threadState == NULL)
+	{
+		PyGILState_Release(gstate);
+	}
+	else
+	{
+		PyThreadState_Clear(threadState);
+		PyThreadState_DeleteCurrent();
 	}
 }
 
 // ---------------------------------------------------------------------------------
-//		 GetParameterString
+//		 Watchdog
 // ---------------------------------------------------------------------------------
-//	Returns the property definition string. Called when an instance of the actor
-//	needs to be instantiated.
+// The watchdog thread. Interrupts the calls whose time is up, checking the deadlines
+// every millisecond while there are any, until the watchdog is stopped. A call that
+// keeps running after it was interrupted gets a new deadline one time limit later,
+// so a function that catches the exception is interrupted again.
 
-static const char*
-GetParameterString(
-	IsadoraParameters*	/* ip */,
-	ActorInfo*			/* inActorInfo */)
+static void
+Watchdog(
+	void*	/* inParam */)
 {
-	return sPropertyDefinitionString;
+	PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+	while (!sWatchdogStop)
+	{
+		if (sDeadlines == NULL)
+		{
+			// Wait until a deadline is added
+			PyThread_release_lock(sDeadlineLock);
+			PyThread_acquire_lock(sWatchdogSignal, WAIT_LOCK);
+			PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+			sWatchdogSignaled = false;
+			continue;
+		}
+
+		double now = GetSeconds();
+		Deadline *deadline = sDeadlines;
+		while (deadline != NULL && (deadline->firing || deadline->time > now))
+			deadline = deadline->next;
+
+		if (deadline == NULL)
+		{
+			PyThread_release_lock(sDeadlineLock);
+			SleepMilliseconds(1);
+			PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+			continue;
+		}
+
+		// The deadline stays in the list until the exception has been raised
+		deadline->firing = true;
+		PyThread_release_lock(sDeadlineLock);
+		InterruptCall(deadline);
+		PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+		deadline->firing = false;
+		deadline->fired = true;
+		deadline->time = GetSeconds() + deadline->interval;
+	}
+	PyThread_release_lock(sDeadlineLock);
+
+	PyThread_release_lock(sWatchdogDone);
 }
 
 // ---------------------------------------------------------------------------------
-//		 GetHelpString
+//		 SignalWatchdog
 // ---------------------------------------------------------------------------------
-//	Returns the help string for a particular property. If you have a fixed number of
-//	input and output properties, it is best to use the PropertyTypeAndIndexToHelpIndex_
-//	function to determine the correct help string to return.
+// Wakes up the watchdog thread. Must be called while holding sDeadlineLock.
 
 static void
-GetHelpString(
-	IsadoraParameters*	ip,
-	ActorInfo*			inActorInfo,
-	PropertyType		inPropertyType,			// kPropertyTypeInvalid when requesting help for the actor
-												// or kInputProperty or kOutputProperty when requesting help for a specific property
-	PropertyIndex		inPropertyIndex1,		// the one-based index of the property (when inPropertyType is not kPropertyTypeInvalid)
-	char*				outParamaterString,		// receives the help string
-	UInt32				inMaxCharacters)		// size of the outParamaterString buffer
+SignalWatchdog()
 {
-	const char* helpstr = nil;
-	// if the input the user is asking about is
-	// past the end of the fixed properties, then
-	// we force it to the first variable property
-	if (inPropertyType == kInputProperty)
+	if (!sWatchdogSignaled)
 	{
-		if (inPropertyIndex1 >= kInputArg0)
-			inPropertyIndex1 = kInputArg0;
+		sWatchdogSignaled = true;
+		PyThread_release_lock(sWatchdogSignal);
 	}
-	
-	// The PropertyTypeAndIndexToHelpIndex_ converts the inPropertyType and
-	// inPropertyIndex1 parameters to determine the zero-based index into
-	// your list of help strings.
-	UInt32 index1 = PropertyTypeAndIndexToHelpIndex_(ip, inActorInfo, inPropertyType, inPropertyIndex1);
-	
-	if (inPropertyType == kOutputProperty)
-		index1 = kInputArg0+inPropertyIndex1;
+}
 
-	// get the help string
-	helpstr = sHelpStrings[index1];
-	
-	// copy it to the output string
-	strncpy(outParamaterString, helpstr, inMaxCharacters);
+// ---------------------------------------------------------------------------------
+//		 StopWatchdog
+// ---------------------------------------------------------------------------------
+// Stops the watchdog thread and waits for it to exit. Must be called without holding
+// the GIL, when no calls are running.
+
+static void
+StopWatchdog()
+{
+	if (!sWatchdogStarted)
+		return;
+
+	PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+	sWatchdogStop = true;
+	SignalWatchdog();
+	PyThread_release_lock(sDeadlineLock);
+
+	PyThread_acquire_lock(sWatchdogDone, WAIT_LOCK);
+
+	// The watchdog may have stopped without waiting for the signal
+	sWatchdogSignaled = false;
+	sWatchdogStop = false;
+	sWatchdogStarted = false;
 }
 
 // ---------------------------------------------------------------------------------
-//		 CreatePropertyID	[INTERRUPT SAFE]
+//		 StartDeadline
 // ---------------------------------------------------------------------------------
+// Adds a deadline for a call that is about to be made on the calling thread, starting
+// the watchdog thread if it is not running yet. If inTimeout is not positive, the call
+// has no time limit. inWorker is the WorkerProcess of a call in the process mode, or
+// NULL. Must be called with the GIL held, and followed by EndDeadline.
 
-inline OSType
-CreatePropertyID(
-	IsadoraParameters*	ip,
-	const char*			inRateBase,
-	SInt32				inIndex)
+static void
+StartDeadline(
+	Deadline*			deadline,
+	PythonInterpreter*	interp,
+	SInt32				inTimeout,
+	PyObject*			inWorker)
 {
-	const SInt32 kOneCharMax = 26;
-	const SInt32 kTwoCharMax = kOneCharMax * kOneCharMax;
-	
-	PluginAssert_(ip, inRateBase[0] != 0 && inRateBase[1] != 0);
-	PluginAssert_(ip, inIndex >= 0 && inIndex < kTwoCharMax * 2);
-	
-	OSType	result = (((UInt32) inRateBase[0]) << 24) | (((UInt32) inRateBase[1]) << 16);
-	
-	SInt32 indexLS;
-	SInt32 indexMS;
-	SInt32 indexOffset;
-	
-	// in index is between 00 and 99
-	if (inIndex >= 0 && inIndex < 100)
-	{	
-		indexMS = inIndex / 10;
-		indexLS = inIndex % 10;
-		
-		result |= ( (((UInt32) (indexMS + '0')) << 8) | (((UInt32) (indexLS + '0')) << 0) );
-		
-		// if between 100 and 776
+	memset(deadline, 0, sizeof(Deadline));
+	if (inTimeout <= 0)
+		return;
+
+	PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+
+	if (!sWatchdogStarted)
+	{
+		sWatchdogStarted = ((long)PyThread_start_new_thread(Watchdog, NULL) != -1);
+		if (!sWatchdogStarted)
+		{
+			PyThread_release_lock(sDeadlineLock);
+			return;
+		}
+	}
+
+	deadline->interval = inTimeout / 1000.0;
+	deadline->time = GetSeconds() + deadline->interval;
+	deadline->thread = (unsigned long) PyThread_get_thread_ident();
+	deadline->interp = interp;
+	deadline->worker = inWorker;
+	deadline->next = sDeadlines;
+	sDeadlines = deadline;
+	SignalWatchdog();
+
+	PyThread_release_lock(sDeadlineLock);
+}
+
+// ---------------------------------------------------------------------------------
+//		 EndDeadline
+// ---------------------------------------------------------------------------------
+// Removes the deadline of a call that has finished. Returns true if the call was
+// interrupted. An exception that was raised after the call finished is discarded.
+// Must be called with the GIL held.
+
+static bool
+EndDeadline(
+	Deadline*	deadline)
+{
+	if (deadline->time == 0)
+		return false;
+
+	PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+
+	// The watchdog needs the GIL to raise the exception
+	while (deadline->firing)
+	{
+		PyThread_release_lock(sDeadlineLock);
+		Py_BEGIN_ALLOW_THREADS
+		SleepMilliseconds(1);
+		Py_END_ALLOW_THREADS
+		PyThread_acquire_lock(sDeadlineLock, WAIT_LOCK);
+	}
+
+	Deadline **link = &sDeadlines;
+	while (*link != deadline)
+		link = &(*link)->next;
+	*link = deadline->next;
+	bool fired = deadline->fired;
+
+	PyThread_release_lock(sDeadlineLock);
+
+	if (fired)
+		PyThreadState_SetAsyncExc(deadline->thread, NULL);
+	return fired;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FormatTimeoutError
+// ---------------------------------------------------------------------------------
+// Replaces the error of a call that was interrupted by its time limit.
+
+static char*
+FormatTimeoutError(
+	char*	inError,
+	SInt32	inTimeout)
+{
+	if (inError == NULL)
+		return NULL;
+
+	free(inError);
+	char *error = (char*) malloc(64);
+	snprintf(error, 64, "timeout: the call took longer than %d ms", (int) inTimeout);
+	return error;
+}
+
+// ---------------------------------------------------------------------------------
+//		 NewPythonInterpreter
+// ---------------------------------------------------------------------------------
+// Allocates the PythonInterpreter struct for an interpreter.
+
+static PythonInterpreter*
+NewPythonInterpreter(
+	SInt32				inGroup,
+	PyInterpreterState*	inState,
+	PyThreadState*		inThreadState)
+{
+	PythonInterpreter *interp = (PythonInterpreter*) calloc(1, sizeof(PythonInterpreter));
+	interp->group = inGroup;
+	interp->state = inState;
+	interp->threadState = inThreadState;
+
+	interp->queueLock = PyThread_allocate_lock();
+	interp->workerSignal = PyThread_allocate_lock();
+	interp->workerDone = PyThread_allocate_lock();
+	PyThread_acquire_lock(interp->workerSignal, WAIT_LOCK);
+	PyThread_acquire_lock(interp->workerDone, WAIT_LOCK);
+
+	return interp;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FreePythonInterpreter
+// ---------------------------------------------------------------------------------
+// Stops the worker thread of an interpreter and frees the PythonInterpreter struct.
+
+static void
+FreePythonInterpreter(
+	PythonInterpreter*	interp)
+{
+	StopAsyncWorker(interp);
+
+	PyThread_free_lock(interp->queueLock);
+	PyThread_free_lock(interp->workerSignal);
+	PyThread_free_lock(interp->workerDone);
+	free(interp);
+}
+
+// ---------------------------------------------------------------------------------
+//		 AcquirePythonInterpreter
+// ---------------------------------------------------------------------------------
+// Adds a reference to the interpreter of an actor group, creating it if this is the
+// first reference. The main interpreter (group 0) is shared by all other actors,
+// and is initialized when the first actor is created. If sub-interpreters are not
+// supported by the python version, all groups use the main interpreter.
+
+static PythonInterpreter*
+AcquirePythonInterpreter(
+	SInt32	inGroup)
+{
+	if (sInterpreterRefCount++ == 0)
+	{
+		sDeadlineLock = PyThread_allocate_lock();
+		sWatchdogSignal = PyThread_allocate_lock();
+		sWatchdogDone = PyThread_allocate_lock();
+		PyThread_acquire_lock(sWatchdogSignal, WAIT_LOCK);
+		PyThread_acquire_lock(sWatchdogDone, WAIT_LOCK);
+
+		// If the host application has already embedded python, we use that interpreter
+		// and leave its lifetime alone.
+		sInterpreterOwned = !Py_IsInitialized();
+		if (sInterpreterOwned)
+		{
+			Py_Initialize();
+#if PY_VERSION_HEX < 0x03070000
+			PyEval_InitThreads();
+#endif
+			// Release the GIL; it is acquired again for each call into python
+			sMainThreadState = PyEval_SaveThread();
+		}
+
+		PyGILState_STATE gstate = PyGILState_Ensure();
+		sNumAsyncWorkers = CountAsyncWorkers();
+		PyGILState_Release(gstate);
+
+		sInterpreters = NewPythonInterpreter(0, NULL, NULL);
+	}
+
+	PythonInterpreter *interp = sInterpreters;
+	while (interp != NULL && interp->group != inGroup)
+		interp = interp->next;
+
+#if PY_VERSION_HEX >= 0x030C0000
+	if (interp == NULL)
+	{
+		PyGILState_STATE gstate = PyGILState_Ensure();
+		PyThreadState *mainThreadState = PyThreadState_Get();
+
+		PyInterpreterConfig config;
+		memset(&config, 0, sizeof(config));
+		config.use_main_obmalloc = 0;
+		config.allow_fork = 0;
+		config.allow_exec = 0;
+		config.allow_threads = 1;
+		config.allow_daemon_threads = 0;
+		config.check_multi_interp_extensions = 1;
+		config.gil = PyInterpreterConfig_OWN_GIL;
+
+		// On success the new interpreter is current, holding its own GIL
+		PyThreadState *threadState = NULL;
+		PyStatus status = Py_NewInterpreterFromConfig(&threadState, &config);
+		if (!PyStatus_Exception(status) && threadState != NULL)
+		{
+			interp = NewPythonInterpreter(inGroup, PyThreadState_GetInterpreter(threadState), threadState);
+			interp->next = sInterpreters->next;
+			sInterpreters->next = interp;
+
+			PyEval_SaveThread();
+			PyEval_RestoreThread(mainThreadState);
+		}
+		else
+		{
+			PyThreadState_Swap(mainThreadState);
+		}
+		PyGILState_Release(gstate);
+	}
+#endif
+
+	if (interp == NULL)
+		interp = sInterpreters;
+
+	interp->refCount++;
+	return interp;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReleasePythonInterpreter
+// ---------------------------------------------------------------------------------
+// Removes a reference to an interpreter. Sub-interpreters are ended when their last
+// actor is disposed, the main interpreter is finalized when the last actor is
+// disposed.
+
+static void
+ReleasePythonInterpreter(
+	PythonInterpreter*	interp)
+{
+	if (interp == NULL || sInterpreterRefCount == 0)
+		return;
+
+	if (--interp->refCount == 0 && interp != sInterpreters)
+	{
+		PythonInterpreter **link = &sInterpreters->next;
+		while (*link != interp)
+			link = &(*link)->next;
+		*link = interp->next;
+
+		PyThreadState *threadState = interp->threadState;
+		FreePythonInterpreter(interp);
+
+		PyEval_RestoreThread(threadState);
+		Py_EndInterpreter(threadState);
+	}
+
+	if (--sInterpreterRefCount > 0)
+		return;
+
+	FreePythonInterpreter(sInterpreters);
+	sInterpreters = NULL;
+
+	StopWatchdog();
+	PyThread_free_lock(sWatchdogSignal);
+	PyThread_free_lock(sWatchdogDone);
+	sWatchdogSignal = sWatchdogDone = NULL;
+
+	PyThread_free_lock(sDeadlineLock);
+	sDeadlineLock = NULL;
+
+	if (!sInterpreterOwned)
+		return;
+
+	PyEval_RestoreThread(sMainThreadState);
+	sMainThreadState = NULL;
+	Py_Finalize();
+	sInterpreterOwned = false;
+}
+
+// ---------------------------------------------------------------------------------
+//		 EnterPythonInterpreter
+// ---------------------------------------------------------------------------------
+// Acquires the GIL of an interpreter on the calling thread. The returned state must
+// be passed to LeavePythonInterpreter. Sub-interpreters are entered through the
+// thread state created for the main thread, so they can not be entered from other
+// threads this way.
+
+static PyGILState_STATE
+EnterPythonInterpreter(
+	PythonInterpreter*	interp)
+{
+	if (interp->threadState == NULL)
+		return PyGILState_Ensure();
+
+	PyEval_RestoreThread(interp->threadState);
+	return PyGILState_UNLOCKED;
+}
+
+// ---------------------------------------------------------------------------------
+//		 LeavePythonInterpreter
+// ---------------------------------------------------------------------------------
+// Releases the GIL acquired by EnterPythonInterpreter.
+
+static void
+LeavePythonInterpreter(
+	PythonInterpreter*	interp,
+	PyGILState_STATE	inState)
+{
+	if (interp->threadState == NULL)
+		PyGILState_Release(inState);
+	else
+		PyEval_SaveThread();
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReleasePythonObjects
+// ---------------------------------------------------------------------------------
+// Releases the python objects of an actor, before it is disposed or moved to another
+// interpreter. A queued or running asynchronous call of the actor will not deliver
+// its result anymore.
+
+static void
+ReleasePythonObjects(
+	PluginInfo*	info)
+{
+	PyThread_acquire_lock(info->mAsyncCall->dataLock, WAIT_LOCK);
+	info->mAsyncCall->disposed = true;
+	PyThread_release_lock(info->mAsyncCall->dataLock);
+
+	PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+	ReleaseAsyncCall(info->mAsyncCall);
+	info->mAsyncCall = NULL;
+	Py_CLEAR(info->mPyFunc);
+	Py_CLEAR(info->mPyModule);
+	Py_CLEAR(info->mArgTuple);
+	Py_CLEAR(info->mKwNames);
+	Py_CLEAR(info->mStream);
+	LeavePythonInterpreter(info->mInterpreter, gstate);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ResetArgTuple
+// ---------------------------------------------------------------------------------
+// Releases the reused tuple of arguments, so all arguments are converted again from
+// their inputs on the next call. Must be called without holding the GIL.
+
+static void
+ResetArgTuple(
+	PluginInfo*	info)
+{
+	UInt32 i;
+	
+	if (info->mArgTuple != NULL)
+	{
+		PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+		Py_CLEAR(info->mArgTuple);
+		LeavePythonInterpreter(info->mInterpreter, gstate);
+	}
+	info->mArgTupleInputs = 0;
+
+	for (i=0; i<info->mNumArgs; i++)
+		info->mArgs[i].dirty = true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FreePythonResult
+// ---------------------------------------------------------------------------------
+// Frees the string data and items of a converted return value.
+
+static void
+FreePythonResult(
+	PythonResult*	ioResult)
+{
+	unsigned int i;
+	for (i=0; i<ioResult->numItems; i++)
+		FreePythonResult(&ioResult->items[i]);
+	free(ioResult->items);
+	free(ioResult->str);
+	free(ioResult->key);
+	memset(ioResult, 0, sizeof(PythonResult));
+}
+
+// ---------------------------------------------------------------------------------
+//		 FreeValueOutputs
+// ---------------------------------------------------------------------------------
+// Frees an array of value output descriptions.
+
+static void
+FreeValueOutputs(
+	ValueOutput*	outputs,
+	unsigned int	numOutputs)
+{
+	unsigned int i;
+	for (i=0; i<numOutputs; i++)
+		free(outputs[i].name);
+	free(outputs);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ClearResultCache
+// ---------------------------------------------------------------------------------
+// Removes all entries from the result cache of an actor, and resets its counters.
+
+static void
+ClearResultCache(
+	ResultCache*	cache)
+{
+	CacheEntry *entry = cache->newest;
+	while (entry != NULL)
+	{
+		CacheEntry *older = entry->older;
+		FreeArgValues(entry->args, entry->numArgs);
+		FreePythonResult(&entry->result);
+		free(entry);
+		entry = older;
+	}
+	free(cache->buckets);
+	cache->buckets = NULL;
+	cache->numBuckets = 0;
+	cache->count = 0;
+	cache->newest = cache->oldest = NULL;
+	cache->hits = cache->misses = 0;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ClearWatchedFiles
+// ---------------------------------------------------------------------------------
+// Stops watching the source files of the module.
+
+static void
+ClearWatchedFiles(
+	PluginInfo* info )
+{
+	if (info->mWatchedFiles != NULL)
+	{
+		unsigned int i;
+		for (i=0; i<info->mNumWatchedFiles; i++)
+		{
+			free(info->mWatchedFiles[i].path);
+		}
+		free(info->mWatchedFiles);
+		info->mWatchedFiles = NULL;
+	}
+	info->mNumWatchedFiles = 0;
+}
+
+// ---------------------------------------------------------------------------------
+//		 WatchFile
+// ---------------------------------------------------------------------------------
+// Appends a source file to the watched files of an actor, if it exists. There must
+// be room for it in mWatchedFiles. Must be called with the GIL held.
+
+static void
+WatchFile(
+	PluginInfo*	info,
+	PyObject*	inPath)
+{
+	const char *file = PyString_Check(inPath) ? PyString_AsString(inPath) : NULL;
+	
+	struct stat st;
+	if (file != NULL && stat(file, &st) == 0)
+	{
+		WatchedFile *watched = &info->mWatchedFiles[info->mNumWatchedFiles++];
+		watched->path = static_cast<char*>(malloc(strlen(file)+1));
+		strcpy(watched->path, file);
+		watched->mtime = st.st_mtime;
+		watched->size = st.st_size;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 WatchModuleFiles
+// ---------------------------------------------------------------------------------
+// Records the modification time and size of the source files of the resolved
+// module, its toplevel package and all submodules of that package. Must be called
+// with the GIL held.
+
+static void
+WatchModuleFiles(
+	PluginInfo* info )
+{
+	ClearWatchedFiles(info);
+	
+	if (info->mPyModule == NULL)
+		return;
+	
+	PyObject *pName = PyObject_GetAttrString(info->mPyModule, "__name__");
+	const char *name = (pName != NULL) ? PyString_AsString(pName) : NULL;
+	if (name == NULL)
+	{
+		Py_XDECREF(pName);
+		PyErr_Clear();
+		return;
+	}
+	
+	const char *dot = strchr(name, '.');
+	size_t topLen = (dot != NULL) ? (size_t)(dot - name) : strlen(name);
+	
+	// a copy of the items of sys.modules, which other threads can change meanwhile
+	PyObject *pItems = PyDict_Items(PyImport_GetModuleDict());
+	Py_ssize_t i, size = (pItems != NULL) ? PyList_GET_SIZE(pItems) : 0;
+	info->mWatchedFiles = (WatchedFile*)malloc((size + 1) * sizeof(WatchedFile));
+	
+	for (i=0; i<size; i++)
+	{
+		// only the toplevel package and its submodules
+		PyObject *pItem = PyList_GET_ITEM(pItems, i);
+		PyObject *pKey = PyTuple_GET_ITEM(pItem, 0);
+		const char *key = PyString_Check(pKey) ? PyString_AsString(pKey) : NULL;
+		if (key == NULL || strncmp(key, name, topLen) != 0 || (key[topLen] != 0 && key[topLen] != '.'))
+			continue;
+		
+		PyObject *pFile = PyObject_GetAttrString(PyTuple_GET_ITEM(pItem, 1), "__file__");
+		if (pFile != NULL)
+			WatchFile(info, pFile);
+		Py_XDECREF(pFile);
+	}
+	
+	Py_XDECREF(pItems);
+	Py_DECREF(pName);
+	PyErr_Clear();
+}
+
+// ---------------------------------------------------------------------------------
+//		 WatchWorkerFiles
+// ---------------------------------------------------------------------------------
+// Records the modification time and size of the source files reported by the
+// worker process of an actor, which imported the module. Must be called with the
+// GIL held.
+
+static void
+WatchWorkerFiles(
+	PluginInfo*	info,
+	PyObject*	inWorker)
+{
+	ClearWatchedFiles(info);
+	
+	PyObject *pFiles = PyObject_GetAttrString(inWorker, "files");
+	if (pFiles != NULL && PyList_Check(pFiles))
+	{
+		info->mWatchedFiles = (WatchedFile*)malloc((PyList_GET_SIZE(pFiles) + 1) * sizeof(WatchedFile));
+		
+		Py_ssize_t i;
+		for (i=0; i<PyList_GET_SIZE(pFiles); i++)
+			WatchFile(info, PyList_GET_ITEM(pFiles, i));
+	}
+	
+	Py_XDECREF(pFiles);
+	PyErr_Clear();
+}
+
+// ---------------------------------------------------------------------------------
+//		 WatchedFilesChanged
+// ---------------------------------------------------------------------------------
+// Returns true if any of the watched source files has changed since the module was
+// loaded. Does not need the GIL.
+
+static bool
+WatchedFilesChanged(
+	PluginInfo* info )
+{
+	bool changed = false;
+	
+	unsigned int i;
+	for (i=0; i<info->mNumWatchedFiles; i++)
+	{
+		WatchedFile *watched = &info->mWatchedFiles[i];
+		
+		struct stat st;
+		if (stat(watched->path, &st) != 0)
+			continue;
+		
+		if (st.st_mtime != watched->mtime || st.st_size != watched->size)
+		{
+			// Remember the change, so a failing reload is not repeated
+			watched->mtime = st.st_mtime;
+			watched->size = st.st_size;
+			changed = true;
+		}
+	}
+	
+	return changed;
+}
+
+// ---------------------------------------------------------------------------------
+//		 UnloadPythonModule
+// ---------------------------------------------------------------------------------
+// Removes the toplevel package of a module and all its submodules from sys.modules,
+// so the next import executes the source files again. If the module was already
+// replaced in sys.modules (eg because another actor reloaded it), nothing is
+// removed. Must be called with the GIL held.
+
+static void
+UnloadPythonModule(
+	PyObject* inModule )
+{
+	PyObject *pName = PyObject_GetAttrString(inModule, "__name__");
+	const char *name = (pName != NULL) ? PyString_AsString(pName) : NULL;
+	PyObject *pModules = PyImport_GetModuleDict();
+	PyObject *pLoaded = NULL;
+	if (name != NULL)
+		PyDict_GetItemStringRef(pModules, name, &pLoaded);
+	
+	if (pLoaded == inModule)
+	{
+		const char *dot = strchr(name, '.');
+		size_t topLen = (dot != NULL) ? (size_t)(dot - name) : strlen(name);
+		
+		// iterate over a copy of the keys; the dict can not be changed while iterating
+		// it, and other threads can change it as well
+		PyObject *pKeys = PyDict_Keys(pModules);
+		Py_ssize_t i, size = (pKeys != NULL) ? PyList_GET_SIZE(pKeys) : 0;
+		for (i=0; i<size; i++)
+		{
+			PyObject *pKey = PyList_GET_ITEM(pKeys, i);
+			const char *key = PyString_Check(pKey) ? PyString_AsString(pKey) : NULL;
+			if (key != NULL && strncmp(key, name, topLen) == 0 && (key[topLen] == 0 || key[topLen] == '.'))
+				PyDict_DelItem(pModules, pKey);
+		}
+		Py_XDECREF(pKeys);
+	}
+	
+	Py_XDECREF(pLoaded);
+	Py_XDECREF(pName);
+	PyErr_Clear();
+}
+
+// ---------------------------------------------------------------------------------
+//		 CopyString
+// ---------------------------------------------------------------------------------
+// Returns a copy of a string allocated with malloc, or an empty string for NULL.
+
+static char*
+CopyString(
+	const char*	inString)
+{
+	if (inString == NULL)
+		inString = "";
+	
+	char *str = static_cast<char*>(malloc(strlen(inString)+1));
+	strcpy(str, inString);
+	return str;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FreeDiscoveredFuncs
+// ---------------------------------------------------------------------------------
+// Frees a list of discovered functions.
+
+static void
+FreeDiscoveredFuncs(
+	DiscoveredFunc*	entry)
+{
+	while (entry != NULL)
+	{
+		DiscoveredFunc *next = entry->next;
+		
+		unsigned int i;
+		for (i=0; i<entry->numFiles; i++)
+			free(entry->files[i].path);
+		for (i=0; i<entry->numArgs; i++)
+			free(entry->argNames[i]);
+		
+		free(entry->path);
+		free(entry->file);
+		free(entry->func);
+		free(entry->files);
+		free(entry->argNames);
+		FreeArgValues(entry->args, entry->numArgs);
+		free(entry);
+		entry = next;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReserveArgs
+// ---------------------------------------------------------------------------------
+// Makes room for the arguments of an actor and their names in its argument block.
+// The block is only reallocated when it has to grow. Returns where the names go.
+
+static char*
+ReserveArgs(
+	PluginInfo*		info,
+	unsigned int	inNumArgs,
+	size_t			inNamesSize)
+{
+	size_t size = inNumArgs * sizeof(Property) + inNamesSize;
+	if (size > info->mArgsSize)
+	{
+		free(info->mArgs);
+		info->mArgs = (Property*) malloc(size);
+		info->mArgsSize = size;
+	}
+	return (char*)(info->mArgs + inNumArgs);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ClearArgs
+// ---------------------------------------------------------------------------------
+// Releases the string values of the arguments of an actor. The argument block is
+// kept for the next discovery.
+
+static void
+ClearArgs(
+	IsadoraParameters*	ip,
+	PluginInfo*			info)
+{
+	unsigned int i;
+	for (i=0; i<info->mNumArgs; i++)
+	{
+		if (info->mArgs[i].value.type == kString)
+			ReleaseValueString_(ip, &info->mArgs[i].value);
+	}
+	info->mNumArgs = 0;
+	info->mNumKeywordArgs = 0;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CreateActor
+// ---------------------------------------------------------------------------------
+// Called once, prior to the first activation of an actor in its Scene. The
+// corresponding DisposeActor actor function will not be called until the file
+// owning this actor is closed, or the actor is destroyed as a result of being
+// cut or deleted.
+
+static void
+CreateActor(
+	IsadoraParameters*	ip,	
+	ActorInfo*			ioActorInfo)		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
+{
+	// create the PluginInfo struct - initializing it to all zeroes
+	PluginInfo* info = (PluginInfo*) IzzyMallocClear_(ip, sizeof(PluginInfo));
+	PluginAssert_(ip, info != nil);
+	
+	ioActorInfo->mActorDataPtr = info;
+	info->mActorInfoPtr = ioActorInfo;
+	
+	info->mNumArgs = 0;
+	info->mNumKeywordArgs = 0;
+	info->mFuncFound = false;
+	info->mArgs = NULL;
+	info->mArgsSize = 0;
+	info->mPyModule = NULL;
+	info->mPyFunc = NULL;
+	info->mFuncKind = kFuncPlain;
+	info->mStateful = false;
+	info->mArgTuple = NULL;
+	info->mKwNames = NULL;
+	info->mArgTupleInputs = 0;
+	
+	info->mAutoReload = true;
+	info->mWatchedFiles = NULL;
+	info->mNumWatchedFiles = 0;
+	info->mWatchTicks = 0;
+	info->mMessageReceiver = NULL;
+	
+	info->mInterpreter = AcquirePythonInterpreter(0);
+	
+	info->mProcess = false;
+	
+	info->mAsync = false;
+	info->mAsyncCall = NewAsyncCall();
+	
+	info->mBatch = false;
+	info->mBatchPending = false;
+	info->mBatchDone = false;
+	memset(&info->mBatchResult, 0, sizeof(PythonResult));
+	info->mBatchError = NULL;
+	
+	memset(&info->mCache, 0, sizeof(ResultCache));
+	
+	info->mMap = false;
+	info->mMapType = kString;
+	strcpy(info->mSeparator, ",");
+	
+	info->mStreamMode = 0;
+	info->mStream = NULL;
+	
+	info->mTimeout = 0;
+	info->mOverruns = 0;
+	
+	info->mStatsOn = false;
+	memset(&info->mStats, 0, sizeof(CallStats));
+	
+	info->mOutputType = 0;
+	info->mAnnotatedKind = kResultSingle;
+	info->mAnnotatedType = kString;
+	info->mAnnotatedOutputs = NULL;
+	info->mNumAnnotatedOutputs = 0;
+	info->mResultKind = kResultSingle;
+	info->mResultType = kString;
+	info->mValueOutputs = NULL;
+	info->mNumValueOutputs = 0;
+	info->mValueOutputsKnown = false;
+	
+	sActors = (ActorInfo**) realloc(sActors, (sNumActors + 1) * sizeof(ActorInfo*));
+	sActors[sNumActors++] = ioActorInfo;
+	
+	if (sTraceEvents == NULL)
+		sTraceEvents = (TraceEvent*) calloc(kTraceBufferSize, sizeof(TraceEvent));
+}
+
+// ---------------------------------------------------------------------------------
+//		 DisposeActor
+// ---------------------------------------------------------------------------------
+// Called when the file owning this actor is closed, or when the actor is destroyed
+// as a result of its being cut or deleted.
+//
+static void
+DisposeActor(
+	IsadoraParameters*	ip,
+	ActorInfo*			ioActorInfo)		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
+{
+	PluginInfo* info = GetPluginInfo_(ioActorInfo);
+	PluginAssert_(ip, info != nil);
+	
+	// destruction of private member variables
+	if (info->mPath != NULL)
+		free(info->mPath);
+	if (info->mFile != NULL)
+		free(info->mFile);
+	if (info->mFunc != NULL)
+		free(info->mFunc);
+	if (info->mCode != NULL)
+		free(info->mCode);
+	
+	ClearArgs(ip, info);
+	free(info->mArgs);
+	
+	ClearWatchedFiles(info);
+	
+	FreePythonResult(&info->mBatchResult);
+	free(info->mBatchError);
+	FreeValueOutputs(info->mAnnotatedOutputs, info->mNumAnnotatedOutputs);
+	FreeValueOutputs(info->mValueOutputs, info->mNumValueOutputs);
+	ClearResultCache(&info->mCache);
+	
+	unsigned int i;
+	for (i=0; i<sNumActors; i++)
+	{
+		if (sActors[i] == ioActorInfo)
+		{
+			memmove(&sActors[i], &sActors[i + 1], (sNumActors - i - 1) * sizeof(ActorInfo*));
+			sNumActors--;
+			break;
+		}
+	}
+	if (sNumActors == 0)
+	{
+		free(sActors);
+		sActors = NULL;
+		
+		FreeDiscoveredFuncs(sDiscoveredFuncs);
+		sDiscoveredFuncs = NULL;
+	}
+	
+	ReleasePythonObjects(info);
+	ReleasePythonInterpreter(info->mInterpreter);
+	
+	// The worker threads have stopped with the last interpreter
+	if (sNumActors == 0)
+	{
+		if (getenv("IZZY_PYTHON_TRACE") != NULL)
+		{
+			char path[1024];
+			GetTracePath(path, sizeof(path));
+			WriteTraceFile(path);
+		}
+		free(sTraceEvents);
+		sTraceEvents = NULL;
+		sTraceNext = 0;
+	}
+	
+	// destroy the PluginInfo struct allocated with IzzyMallocClear_ the CreateActor function
+	PluginAssert_(ip, ioActorInfo->mActorDataPtr != nil);
+	IzzyFree_(ip, ioActorInfo->mActorDataPtr);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ActivateActor
+// ---------------------------------------------------------------------------------
+//	Called when the scene that owns this actor is activated or deactivated. The
+//	inActivate flag will be true when the scene is activated, false when deactivated.
+//
+static void
+ActivateActor(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
+	Boolean				inActivate)			// true when actor is becoming active, false otherwise.
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	
+	// ------------------------
+	// ACTIVATE
+	// ------------------------
+	if (inActivate)
+	{
+	
+		// Isadora passes various messages to plugins that request them.
+		// These include Mouse Moved messages, Key Down/Key Up messages,
+		// Video Frame Clock messages, etc. The complete list can be found
+		// in the enumeration in MessageReceiverCommon.h
+		
+		// You ask Isadora for these messages by calling CreateMessageReceiver_
+		// with a pointer to your function, and the message types you would
+		// like to receive. (These are bitmapped flags, so you can combine as
+		// many as you like: kWantKeyDown | kWantKeyDown for instance.)
+		
+		// The video frame clock is used to check the module files for changes
+		info->mWatchTicks = 0;
+		info->mMessageReceiver = CreateMessageReceiver_(ip, ReceiveMessage, kWantVideoFrameTick, (MessageRefCon) inActorInfo);
+		
+		// A single receiver runs the batched calls of all actors
+		if (sNumActiveActors++ == 0)
+			sSchedulerReceiver = CreateMessageReceiver_(ip, ReceiveSchedulerMessage, kWantVideoFrameTick, NULL);
+	
+	// ------------------------
+	// DEACTIVATE
+	// ------------------------
+	
+	}
+	else
+	{
+		if (info->mMessageReceiver != NULL)
+		{
+			DisposeMessageReceiver_(ip, info->mMessageReceiver);
+			info->mMessageReceiver = NULL;
+			
+			if (--sNumActiveActors == 0 && sSchedulerReceiver != NULL)
+			{
+				DisposeMessageReceiver_(ip, sSchedulerReceiver);
+				sSchedulerReceiver = NULL;
+			}
+		}
+		
+		// A call that has not run yet is dropped with the scene
+		info->mBatchPending = false;
+		
+		// Don't leave a changed name undiscovered
+		if (info->mDiscoveryTicks > 0)
+			DiscoverPythonFunc(ip, inActorInfo);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 GetParameterString
+// ---------------------------------------------------------------------------------
+//	Returns the property definition string. Called when an instance of the actor
+//	needs to be instantiated.
+
+static const char*
+GetParameterString(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */)
+{
+	return sPropertyDefinitionString;
+}
+
+// ---------------------------------------------------------------------------------
+//		 GetHelpString
+// ---------------------------------------------------------------------------------
+//	Returns the help string for a particular property. If you have a fixed number of
+//	input and output properties, it is best to use the PropertyTypeAndIndexToHelpIndex_
+//	function to determine the correct help string to return.
+
+static void
+GetHelpString(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	PropertyType		inPropertyType,			// kPropertyTypeInvalid when requesting help for the actor
+												// or kInputProperty or kOutputProperty when requesting help for a specific property
+	PropertyIndex		inPropertyIndex1,		// the one-based index of the property (when inPropertyType is not kPropertyTypeInvalid)
+	char*				outParamaterString,		// receives the help string
+	UInt32				inMaxCharacters)		// size of the outParamaterString buffer
+{
+	const char* helpstr = nil;
+	// if the input the user is asking about is
+	// past the end of the fixed properties, then
+	// we force it to the first variable property
+	if (inPropertyType == kInputProperty)
+	{
+		if (inPropertyIndex1 >= kInputArg0)
+			inPropertyIndex1 = kInputArg0;
+	}
+	else if (inPropertyType == kOutputProperty)
+	{
+		if (inPropertyIndex1 >= kOutputValue)
+			inPropertyIndex1 = kOutputValue;
+	}
+	
+	// The PropertyTypeAndIndexToHelpIndex_ converts the inPropertyType and
+	// inPropertyIndex1 parameters to determine the zero-based index into
+	// your list of help strings.
+	UInt32 index1 = PropertyTypeAndIndexToHelpIndex_(ip, inActorInfo, inPropertyType, inPropertyIndex1);
+	
+	if (inPropertyType == kOutputProperty)
+		index1 = kInputArg0+inPropertyIndex1;
+
+	// get the help string
+	helpstr = sHelpStrings[index1];
+	
+	// copy it to the output string
+	strncpy(outParamaterString, helpstr, inMaxCharacters);
+}
+
+// ---------------------------------------------------------------------------------
+//		 CreatePropertyID	[INTERRUPT SAFE]
+// ---------------------------------------------------------------------------------
+
+inline OSType
+CreatePropertyID(
+	IsadoraParameters*	ip,
+	const char*			inRateBase,
+	SInt32				inIndex)
+{
+	const SInt32 kOneCharMax = 26;
+	const SInt32 kTwoCharMax = kOneCharMax * kOneCharMax;
+	
+	PluginAssert_(ip, inRateBase[0] != 0 && inRateBase[1] != 0);
+	PluginAssert_(ip, inIndex >= 0 && inIndex < kTwoCharMax * 2);
+	
+	OSType	result = (((UInt32) inRateBase[0]) << 24) | (((UInt32) inRateBase[1]) << 16);
+	
+	SInt32 indexLS;
+	SInt32 indexMS;
+	SInt32 indexOffset;
+	
+	// in index is between 00 and 99
+	if (inIndex >= 0 && inIndex < 100)
+	{	
+		indexMS = inIndex / 10;
+		indexLS = inIndex % 10;
+		
+		result |= ( (((UInt32) (indexMS + '0')) << 8) | (((UInt32) (indexLS + '0')) << 0) );
+		
+		// if between 100 and 776
+	}
+	else if (inIndex >= 100 && inIndex < 100 + kTwoCharMax)
+	{	
+		indexOffset = inIndex - 100;
+		PluginAssert_(ip, indexOffset >= 0 && indexOffset < kTwoCharMax);
+		indexMS = indexOffset / kOneCharMax;
+		indexLS = indexOffset % kOneCharMax;
+		
+		result |= ( (((UInt32) (indexMS + 'A')) << 8) | (((UInt32) (indexLS + 'A')) << 0) );
+		
+		// if between 776 and 1452
+	}
+	else if (inIndex >= 100 + kTwoCharMax && inIndex < 100 + kTwoCharMax * 2)
+	{	
+		indexOffset = inIndex - (100 + kTwoCharMax);
+		PluginAssert_(ip, indexOffset >= 0 && indexOffset < kTwoCharMax);
+		indexMS = indexOffset / kOneCharMax;
+		indexLS = indexOffset % kOneCharMax;
+		
+		result |= ( (((UInt32) (indexMS + 'a')) << 8) | (((UInt32) (indexLS + 'a')) << 0) );
+		
+	}
+	else
+	{
+		PluginAssert_(ip, false);
+	}
+	
+	return result;
+}
+
+#if PY_MAJOR_VERSION >= 3
+// ---------------------------------------------------------------------------------
+//		 IsExtensionSpec
+// ---------------------------------------------------------------------------------
+// Returns true if a module spec found by importlib is for an extension module.
+
+static bool
+IsExtensionSpec(
+	PyObject*	inMachinery,
+	PyObject*	inSpec)
+{
+	PyObject *pLoader = PyObject_GetAttrString(inSpec, "loader");
+	PyObject *pExtLoader = PyObject_GetAttrString(inMachinery, "ExtensionFileLoader");
+	bool extension = (pLoader != NULL && pExtLoader != NULL && PyObject_IsInstance(pLoader, pExtLoader) == 1);
+	Py_XDECREF(pExtLoader);
+	Py_XDECREF(pLoader);
+	PyErr_Clear();
+	return extension;
+}
+#endif
+
+// ---------------------------------------------------------------------------------
+//		 LoadPythonModuleFromPath
+// ---------------------------------------------------------------------------------
+// Finds the toplevel module inModule (inModuleLen characters) in the directory
+// inPath, and executes it as a new module named inUniqueName. The module is added
+// to sys.modules under that name. Extension modules can only be initialised under
+// their own name, so they are loaded under that name and then added under the unique
+// name as well. The directory is added to the end of sys.path, so the module can
+// import the modules next to it. Returns a new reference, or NULL with a python
+// error set.
+
+static PyObject*
+LoadPythonModuleFromPath(
+	const char*	inUniqueName,
+	const char*	inPath,
+	const char*	inModule,
+	size_t		inModuleLen)
+{
+	PyObject *pModule = NULL, *pName, *pPathList;
+	
+	pName = PyString_FromStringAndSize(inModule, inModuleLen);
+	pPathList = Py_BuildValue("[s]", inPath);
+	if (pName == NULL || pPathList == NULL)
+	{
+		Py_XDECREF(pName);
+		Py_XDECREF(pPathList);
+		return NULL;
+	}
+	
+	PyObject *pSysPath = PySys_GetObject((char*)"path");
+	PyObject *pDir = PyList_GetItem(pPathList, 0);
+	if (pSysPath != NULL && PyList_Check(pSysPath) && PySequence_Contains(pSysPath, pDir) == 0)
+		PyList_Append(pSysPath, pDir);
+	PyErr_Clear();
+	
+#if PY_MAJOR_VERSION >= 3
+	// importlib finds packages, source, bytecode and extension modules
+	PyObject *pMachinery = PyImport_ImportModule("importlib.machinery");
+	PyObject *pUtil = PyImport_ImportModule("importlib.util");
+	if (pMachinery != NULL && pUtil != NULL)
+	{
+		PyObject *pFinder = PyObject_GetAttrString(pMachinery, "PathFinder");
+		PyObject *pFound = (pFinder != NULL) ? PyObject_CallMethod(pFinder, "find_spec", "OO", pName, pPathList) : NULL;
+		PyObject *pSpec = NULL;
+		
+		if (pFound == Py_None)
+		{
+			PyErr_Format(PyExc_ImportError, "No module named '%s' in %s", PyString_AsString(pName), inPath);
+		}
+		else if (pFound != NULL && IsExtensionSpec(pMachinery, pFound))
+		{
+			Py_INCREF(pFound);
+			pSpec = pFound;
+		}
+		else if (pFound != NULL)
+		{
+			// Recreate the spec under the unique name; loaders are bound to the module name
+			PyObject *pOrigin = PyObject_GetAttrString(pFound, "origin");
+			PyObject *pSearch = PyObject_GetAttrString(pFound, "submodule_search_locations");
+			PyObject *pSpecFunc = PyObject_GetAttrString(pUtil, "spec_from_file_location");
+			PyObject *pSpecArgs = Py_BuildValue("(sO)", inUniqueName, pOrigin);
+			PyObject *pSpecKwargs = Py_BuildValue("{s:O}", "submodule_search_locations", pSearch);
+			if (pOrigin != NULL && pSearch != NULL && pSpecFunc != NULL && pSpecArgs != NULL && pSpecKwargs != NULL)
+			{
+				pSpec = PyObject_Call(pSpecFunc, pSpecArgs, pSpecKwargs);
+			}
+			Py_XDECREF(pSpecKwargs);
+			Py_XDECREF(pSpecArgs);
+			Py_XDECREF(pSpecFunc);
+			Py_XDECREF(pSearch);
+			Py_XDECREF(pOrigin);
+		}
+		
+		if (pSpec == Py_None)
+		{
+			PyErr_Format(PyExc_ImportError, "Cannot load module '%s' from %s", PyString_AsString(pName), inPath);
+		}
+		else if (pSpec != NULL)
+		{
+			pModule = PyObject_CallMethod(pUtil, "module_from_spec", "O", pSpec);
+			if (pModule != NULL)
+			{
+				// The module must be in sys.modules while it executes, for relative imports
+				PyDict_SetItemString(PyImport_GetModuleDict(), inUniqueName, pModule);
+				
+				PyObject *pLoader = PyObject_GetAttrString(pSpec, "loader");
+				PyObject *pResult = (pLoader != NULL) ? PyObject_CallMethod(pLoader, "exec_module", "O", pModule) : NULL;
+				if (pResult == NULL)
+				{
+					PyObject *pErrType, *pErrValue, *pTraceback;
+					PyErr_Fetch(&pErrType, &pErrValue, &pTraceback);
+					PyDict_DelItemString(PyImport_GetModuleDict(), inUniqueName);
+					PyErr_Restore(pErrType, pErrValue, pTraceback);
+					Py_CLEAR(pModule);
+				}
+				Py_XDECREF(pResult);
+				Py_XDECREF(pLoader);
+			}
+		}
+		Py_XDECREF(pSpec);
+		Py_XDECREF(pFound);
+		Py_XDECREF(pFinder);
+	}
+	Py_XDECREF(pUtil);
+	Py_XDECREF(pMachinery);
+#else
+	PyObject *pImp = PyImport_ImportModule("imp");
+	if (pImp != NULL)
+	{
+		// find_module returns a (file, pathname, description) tuple
+		PyObject *pFound = PyObject_CallMethod(pImp, "find_module", "OO", pName, pPathList);
+		if (pFound != NULL)
+		{
+			// The description is a (suffix, mode, type) tuple
+			PyObject *pFile = PyTuple_GetItem(pFound, 0);
+			PyObject *pType = PyTuple_GetItem(PyTuple_GetItem(pFound, 2), 2);
+			PyObject *pExtType = PyObject_GetAttrString(pImp, "C_EXTENSION");
+			bool extension = (pExtType != NULL && PyObject_RichCompareBool(pType, pExtType, Py_EQ) == 1);
+			Py_XDECREF(pExtType);
+			PyErr_Clear();
+			
+			pModule = PyObject_CallMethod(pImp, "load_module", "sOOO", extension ? PyString_AsString(pName) : inUniqueName,
+				pFile, PyTuple_GetItem(pFound, 1), PyTuple_GetItem(pFound, 2));
+			if (pModule != NULL && extension)
+				PyDict_SetItemString(PyImport_GetModuleDict(), inUniqueName, pModule);
+			if (pFile != Py_None)
+			{
+				PyObject *pResult = PyObject_CallMethod(pFile, "close", NULL);
+				Py_XDECREF(pResult);
+			}
+			Py_DECREF(pFound);
+		}
+		Py_DECREF(pImp);
+	}
+#endif
+	
+	Py_DECREF(pName);
+	Py_DECREF(pPathList);
+	
+	return pModule;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ImportPythonModule
+// ---------------------------------------------------------------------------------
+// Imports a (possibly dotted) module from the directory inPath. The directory is
+// appended to sys.path once, without duplicates, so the imports of the module itself
+// resolve. The toplevel module is registered in sys.modules under a
+// name that is unique to the directory, so the import is done only once for all
+// actors using it, and modules with the same name in different directories don't
+// collide. If no directory is specified, the module is imported from sys.path.
+// Returns a new reference, or NULL with a python error set.
+
+static PyObject*
+ImportPythonModule(
+	const char*	inPath,
+	const char*	inModule)
+{
+	if (inPath == NULL || strlen(inPath) == 0)
+		return PyImport_ImportModule(inModule);
+	
+	const char* dot = strchr(inModule, '.');
+	size_t topLen = (dot != NULL) ? (size_t)(dot - inModule) : strlen(inModule);
+	
+	// FNV-1a hash of the directory
+	UInt32 hash = 2166136261u;
+	const char* c;
+	for (c = inPath; *c != 0; c++)
+		hash = (hash ^ (unsigned char)*c) * 16777619u;
+	
+	char *uniqueName = (char*)malloc( strlen(inModule)+16 );
+	sprintf(uniqueName, "_izzy%08x_%.*s", (unsigned int)hash, (int)topLen, inModule);
+	
+	PyObject *pModule;
+	if (PyDict_GetItemStringRef(PyImport_GetModuleDict(), uniqueName, &pModule) == 0)
+		pModule = LoadPythonModuleFromPath(uniqueName, inPath, inModule, topLen);
+	
+	// Submodules are found through the __path__ of the toplevel package
+	if (pModule != NULL && dot != NULL)
+	{
+		strcat(uniqueName, dot);
+		Py_DECREF(pModule);
+		pModule = PyImport_ImportModule(uniqueName);
+	}
+	
+	free(uniqueName);
+	return pModule;
+}
+
+// ---------------------------------------------------------------------------------
+//		 AnnotationToValueType
+// ---------------------------------------------------------------------------------
+// Returns the value type that matches a type annotation, or kString if it is not a
+// number or boolean. Annotations postponed with "from __future__ import annotations"
+// are recognised by name. Must be called with the GIL held.
+
+static ValueType
+AnnotationToValueType(
+	PyObject*	inAnnotation)
+{
+	const char *name = NULL;
+	if (PyType_Check(inAnnotation))
+		name = ((PyTypeObject*)inAnnotation)->tp_name;
+	else if (PyString_Check(inAnnotation))
+		name = PyString_AsString(inAnnotation);
+
+	if (name == NULL)
+		return kString;
+	if (strcmp(name, "int") == 0)
+		return kInteger;
+	if (strcmp(name, "float") == 0)
+		return kFloat;
+	if (strcmp(name, "bool") == 0)
+		return kBoolean;
+	return kString;
+}
+
+// ---------------------------------------------------------------------------------
+//		 AddAnnotatedOutput
+// ---------------------------------------------------------------------------------
+// Appends a value output for an element of a tuple or dict return annotation.
+
+static void
+AddAnnotatedOutput(
+	PluginInfo*		info,
+	const char*		inName,
+	ValueType		inType)
+{
+	info->mAnnotatedOutputs = (ValueOutput*) realloc(info->mAnnotatedOutputs, (info->mNumAnnotatedOutputs + 1) * sizeof(ValueOutput));
+	ValueOutput *output = &info->mAnnotatedOutputs[info->mNumAnnotatedOutputs++];
+	output->name = static_cast<char*>(malloc(strlen(inName)+1));
+	strcpy(output->name, inName);
+	output->type = inType;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReadReturnAnnotation
+// ---------------------------------------------------------------------------------
+// Determines the kind and type of the return value from the return annotation of a
+// function. Tuple[...] annotations get an output per element; NamedTuple and
+// TypedDict classes get an output per field, named after the field. Everything else
+// is a single value, of type kString unless it is annotated as a number or boolean.
+// For generator functions, the type of the yielded values is taken from their
+// Iterator[...] or Generator[...] annotation. Must be called with the GIL held.
+
+static void
+ReadReturnAnnotation(
+	PluginInfo*		info,
+	PyObject*		inFunc,
+	bool			inYields)
+{
+	PyObject *pAnnotations = PyObject_GetAttrString(inFunc, "__annotations__");
+	PyObject *pReturn = NULL;
+	if (pAnnotations != NULL && PyDict_Check(pAnnotations))
+		PyDict_GetItemStringRef(pAnnotations, "return", &pReturn);
+	if (pReturn != NULL && inYields)
+	{
+		PyObject *pYields = PyObject_GetAttrString(pReturn, "__args__");
+		Py_DECREF(pReturn);
+		pReturn = (pYields != NULL && PyTuple_Check(pYields) && PyTuple_GET_SIZE(pYields) > 0) ? PyTuple_GET_ITEM(pYields, 0) : NULL;
+		Py_XINCREF(pReturn);
+		Py_XDECREF(pYields);
+	}
+	PyErr_Clear();
+
+	if (pReturn == NULL)
+	{
+		Py_XDECREF(pAnnotations);
+		return;
+	}
+
+	PyObject *pFields = NULL, *pTypes = NULL, *pArgs = NULL;
+	if (PyType_Check(pReturn) && PyType_IsSubtype((PyTypeObject*)pReturn, &PyTuple_Type))
+	{
+		// NamedTuple: the fields, with types if it was declared with annotations
+		pFields = PyObject_GetAttrString(pReturn, "_fields");
+		pTypes = PyObject_GetAttrString(pReturn, "__annotations__");
+		if (pFields != NULL && PyTuple_Check(pFields))
+			info->mAnnotatedKind = kResultTuple;
+	}
+	else if (PyType_Check(pReturn) && PyType_IsSubtype((PyTypeObject*)pReturn, &PyDict_Type))
+	{
+		// TypedDict: the keys and their types
+		pTypes = PyObject_GetAttrString(pReturn, "__annotations__");
+		if (pTypes != NULL && PyDict_Check(pTypes) && PyObject_HasAttrString(pReturn, "__total__"))
+		{
+			pFields = PyDict_Keys(pTypes);
+			info->mAnnotatedKind = kResultDict;
+		}
+	}
+	else
+	{
+		// Tuple[...] and tuple[...]: the element types; Tuple[int, ...] has no fixed length
+		PyObject *pOrigin = PyObject_GetAttrString(pReturn, "__origin__");
+		pArgs = PyObject_GetAttrString(pReturn, "__args__");
+		bool isTuple = (pOrigin == (PyObject*)&PyTuple_Type);
+		if (!isTuple && pOrigin != NULL)
+		{
+			// the origin of typing.Tuple is typing.Tuple itself before Python 3.7
+			PyObject *pName = PyObject_Str(pOrigin);
+			const char *name = (pName != NULL) ? PyString_AsString(pName) : NULL;
+			isTuple = (name != NULL && strcmp(name, "typing.Tuple") == 0);
+			Py_XDECREF(pName);
+		}
+		if (isTuple && pArgs != NULL && PyTuple_Check(pArgs) && PyTuple_Size(pArgs) > 0
+			&& PyTuple_GetItem(pArgs, PyTuple_Size(pArgs) - 1) != Py_Ellipsis)
+		{
+			info->mAnnotatedKind = kResultTuple;
+		}
+		Py_XDECREF(pOrigin);
+	}
+	PyErr_Clear();
+
+	Py_ssize_t i, size;
+	char name[32];
+	if (info->mAnnotatedKind == kResultSingle)
+	{
+		info->mAnnotatedType = AnnotationToValueType(pReturn);
+	}
+	else if (pFields != NULL)
+	{
+		size = PySequence_Size(pFields);
+		for (i=0; i<size; i++)
+		{
+			PyObject *pField = PySequence_GetItem(pFields, i);
+			PyObject *pType = NULL;
+			if (pTypes != NULL && PyDict_Check(pTypes))
+				PyDict_GetItemRef(pTypes, pField, &pType);
+			const char *fieldName = PyString_Check(pField) ? PyString_AsString(pField) : NULL;
+			if (fieldName != NULL)
+				AddAnnotatedOutput(info, fieldName, (pType != NULL) ? AnnotationToValueType(pType) : kString);
+			Py_XDECREF(pType);
+			Py_DECREF(pField);
+		}
+	}
+	else
+	{
+		size = PyTuple_Size(pArgs);
+		for (i=0; i<size; i++)
+		{
+			snprintf(name, sizeof(name), "value_%d", (int)(i + 1));
+			AddAnnotatedOutput(info, name, AnnotationToValueType(PyTuple_GetItem(pArgs, i)));
+		}
+	}
+	PyErr_Clear();
+
+	Py_XDECREF(pFields);
+	Py_XDECREF(pTypes);
+	Py_XDECREF(pArgs);
+	Py_XDECREF(pReturn);
+	Py_XDECREF(pAnnotations);
+}
+
+// ---------------------------------------------------------------------------------
+//		 UpdateResultType
+// ---------------------------------------------------------------------------------
+// Determines how return values are converted, from the output_type input or the
+// return annotation of the function, and adds the value outputs for them to the
+// actor after the fixed outputs.
+
+static void
+UpdateResultType(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	// Results of the previous function or type are no longer valid
+	ClearResultCache(&info->mCache);
+
+	info->mResultKind = kResultSingle;
+	switch (info->mOutputType)
+	{
+		case 1:		info->mResultType = kString;				break;
+		case 2:		info->mResultType = kInteger;				break;
+		case 3:		info->mResultType = kFloat;					break;
+		case 4:		info->mResultType = kBoolean;				break;
+		default:
+			info->mResultKind = info->mAnnotatedKind;
+			info->mResultType = info->mAnnotatedType;
+			break;
+	}
+	
+	// The results of a map are joined into text
+	if (info->mMap)
+	{
+		info->mResultKind = kResultSingle;
+		info->mResultType = kString;
+	}
+
+	// The value outputs needed for this kind of result
+	ValueOutput single;
+	single.name = const_cast<char*>("value");
+	single.type = info->mResultType;
+
+	const ValueOutput *outputs = &single;
+	unsigned int numOutputs = (info->mResultType != kString) ? 1 : 0;
+	if (info->mResultKind != kResultSingle)
+	{
+		outputs = info->mAnnotatedOutputs;
+		numOutputs = info->mNumAnnotatedOutputs;
+	}
+
+	unsigned int i;
+	if (info->mValueOutputsKnown && info->mNumValueOutputs == numOutputs)
+	{
+		for (i=0; i<numOutputs; i++)
+		{
+			if (outputs[i].type != info->mValueOutputs[i].type || strcmp(outputs[i].name, info->mValueOutputs[i].name) != 0)
+				break;
+		}
+		if (i == numOutputs)
+			return;
+	}
+
+	// Remove the previous value outputs
+	UInt32 propCount;
+	IzzyError err = GetPropertyCount_(ip, inActorInfo, kOutputProperty, &propCount);
+	PluginAssert_(ip, err == kIzzyNoError);
+
+	while (propCount >= kOutputValue)
+	{
+		err = RemovePropertyProc_(ip, inActorInfo, kOutputProperty, propCount);
+		PluginAssert_(ip, err == noErr);
+		propCount--;
+	}
+
+	FreeValueOutputs(info->mValueOutputs, info->mNumValueOutputs);
+	info->mValueOutputs = (numOutputs > 0) ? (ValueOutput*) malloc(numOutputs * sizeof(ValueOutput)) : NULL;
+	info->mNumValueOutputs = numOutputs;
+	info->mValueOutputsKnown = true;
+
+	for (i=0; i<numOutputs; i++)
+	{
+		info->mValueOutputs[i].name = static_cast<char*>(malloc(strlen(outputs[i].name)+1));
+		strcpy(info->mValueOutputs[i].name, outputs[i].name);
+		info->mValueOutputs[i].type = outputs[i].type;
+
+		Value valueMin, valueMax, valueInit;
+		PropertyDispFormat fmt = kDisplayFormatNumber;
+		valueMin.type = valueMax.type = valueInit.type = outputs[i].type;
+		if (outputs[i].type == kString)
+		{
+			GetPropertyMinMax_(ip, inActorInfo, kOutputProperty, kOutputResult, &valueMin, &valueMax, NULL);
+			AllocateValueString_(ip, "", &valueInit);
+			fmt = kDisplayFormatText;
+		}
+		else if (outputs[i].type == kInteger)
+		{
+			valueMin.u.ivalue = -2147483647;
+			valueMax.u.ivalue = 2147483647;
+			valueInit.u.ivalue = 0;
+		}
+		else if (outputs[i].type == kFloat)
+		{
+			valueMin.u.fvalue = -2147483647.f;
+			valueMax.u.fvalue = 2147483647.f;
+			valueInit.u.fvalue = 0;
+		}
+		else
+		{
+			valueMin.u.ivalue = 0;
+			valueMax.u.ivalue = 1;
+			valueInit.u.ivalue = 0;
+			fmt = kDisplayFormatOnOff;
+		}
+
+		OSType code = CreatePropertyID(ip, "vl", kValue0PropertyID + i);
+
+		err = AddProperty_(ip, inActorInfo,
+							kOutputProperty,
+							code,
+							FOUR_CHAR_CODE(code),
+							info->mValueOutputs[i].name,
+							fmt,
+							fmt,
+							1,
+							&valueMin,
+							&valueMax,
+							&valueInit);
+		PluginAssert_(ip, err == noErr);
+
+		if (valueInit.type == kString)
+			ReleaseValueString_(ip, &valueInit);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 ConvertValue
+// ---------------------------------------------------------------------------------
+// Converts an Isadora value of a known type to a new python object. FindPythonFunc
+// picks the specialization for each argument once, so calls don't have to switch
+// on the type of every argument. Must be called with the GIL held.
+
+template <ValueType T>
+static PyObject*
+ConvertValue(
+	const Value*	inValue,
+	const char*		inString);
+
+template <>
+PyObject*
+ConvertValue<kInteger>(
+	const Value*	inValue,
+	const char*		/* inString */)
+{
+	return PyInt_FromLong(inValue->u.ivalue);
+}
+
+template <>
+PyObject*
+ConvertValue<kFloat>(
+	const Value*	inValue,
+	const char*		/* inString */)
+{
+	return PyFloat_FromDouble(inValue->u.fvalue);
+}
+
+template <>
+PyObject*
+ConvertValue<kBoolean>(
+	const Value*	inValue,
+	const char*		/* inString */)
+{
+	return PyBool_FromLong(inValue->u.ivalue);
+}
+
+template <>
+PyObject*
+ConvertValue<kString>(
+	const Value*	/* inValue */,
+	const char*		inString)
+{
+	return PyString_FromString(inString != NULL ? inString : "");
+}
+
+// ---------------------------------------------------------------------------------
+//		 ValueToPython
+// ---------------------------------------------------------------------------------
+// Converts an Isadora value to a new python object. The string data of string values
+// is passed separately, so copies of values can be converted as well. Must be
+// called with the GIL held.
+
+static PyObject*
+ValueToPython(
+	const Value*	inValue,
+	const char*		inString)
+{
+	switch(inValue->type)
+	{
+	case kInteger:
+		return ConvertValue<kInteger>(inValue, inString);
+	case kFloat:
+		return ConvertValue<kFloat>(inValue, inString);
+	case kBoolean:
+		return ConvertValue<kBoolean>(inValue, inString);
+	case kString:
+		return ConvertValue<kString>(inValue, inString);
+	default:
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 GetValueConverter
+// ---------------------------------------------------------------------------------
+// Returns the converter for values of the given type.
+
+static ValueConverter
+GetValueConverter(
+	ValueType	inType)
+{
+	switch(inType)
+	{
+	case kInteger:
+		return ConvertValue<kInteger>;
+	case kFloat:
+		return ConvertValue<kFloat>;
+	case kBoolean:
+		return ConvertValue<kBoolean>;
+	case kString:
+		return ConvertValue<kString>;
+	default:
+		return ValueToPython;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 PythonToInt32
+// ---------------------------------------------------------------------------------
+// Converts a python integer to an integer value. A number that does not fit is
+// clamped to the range of the value, and outClamped is set if it is not NULL.
+// Returns false with a python error set if the object can not be converted to an
+// integer. Must be called with the GIL held.
+
+static bool
+PythonToInt32(
+	PyObject*	inObject,
+	SInt32*		outValue,
+	bool*		outClamped)
+{
+	const long kMax = 2147483647L;
+	const long kMin = -kMax - 1;
+	
+	int overflow = 0;
+	long value = PyLong_AsLongAndOverflow(inObject, &overflow);
+	if (value == -1 && overflow == 0 && PyErr_Occurred())
+	{
+		*outValue = 0;
+		return false;
+	}
+	
+	if (overflow != 0)
+		value = (overflow > 0) ? kMax : kMin;
+	bool clamped = (overflow != 0 || value > kMax || value < kMin);
+	if (value > kMax)
+		value = kMax;
+	else if (value < kMin)
+		value = kMin;
+	
+	*outValue = (SInt32) value;
+	if (outClamped != NULL)
+		*outClamped = clamped;
+	return true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 InitArgValue
+// ---------------------------------------------------------------------------------
+// Sets the type and initial value of an argument input. The type is taken from the
+// annotation of the argument if it is int, float, bool or str. Otherwise it is the
+// type of the default value, or for arguments without a default value, the type in
+// the suffix of the name (eg 'count_int'). Other arguments get the type inUntyped.
+
+static void
+InitArgValue(
+	IsadoraParameters*	ip,
+	const char*			inName,
+	PyObject*			inAnnotation,
+	PyObject*			inDefault,
+	ValueType			inUntyped,
+	Value*				outValue)
+{
+	ValueType type = inUntyped;
+	bool typed = false;
+	
+	if (inAnnotation != NULL)
+	{
+		type = AnnotationToValueType(inAnnotation);
+		typed = (type != kString || inAnnotation == (PyObject*)&PyString_Type
+			|| (PyString_Check(inAnnotation) && strcmp(PyString_AsString(inAnnotation), "str") == 0));
+	}
+	if (!typed && inDefault != NULL)
+	{
+		if (PyBool_Check(inDefault))
+			type = kBoolean;
+		else if (PyInt_Check(inDefault))
+			type = kInteger;
+		else if (PyFloat_Check(inDefault))
+			type = kFloat;
+		else // anything from str to tuple, dict, none
+			type = kString;
+		typed = true;
+	}
+	if (!typed)
+	{
+		const char *suffix = strrchr(inName, '_');
+		if (suffix != NULL && strcmp(suffix, "_int") == 0)
+			type = kInteger;
+		else if (suffix != NULL && strcmp(suffix, "_float") == 0)
+			type = kFloat;
+		else if (suffix != NULL && strcmp(suffix, "_bool") == 0)
+			type = kBoolean;
+		else if (suffix != NULL && strcmp(suffix, "_str") == 0)
+			type = kString;
+	}
+	
+	outValue->type = type;
+	switch (type)
+	{
+		case kInteger:
+		{
+			outValue->u.ivalue = 0;
+			PyObject *pLong = (inDefault != NULL) ? PyNumber_Long(inDefault) : NULL;
+			if (pLong != NULL)
+			{
+				PythonToInt32(pLong, &outValue->u.ivalue, NULL);
+				Py_DECREF(pLong);
+			}
+			PyErr_Clear();
+			break;
+		}
+		
+		case kFloat:
+			outValue->u.fvalue = (inDefault != NULL) ? (float)PyFloat_AsDouble(inDefault) : 0;
+			if (PyErr_Occurred())
+				outValue->u.fvalue = 0;
+			break;
+		
+		case kBoolean:
+			outValue->u.ivalue = (inDefault != NULL) ? (PyObject_IsTrue(inDefault) == 1) : 0;
+			break;
+		
+		default:
+		{
+			PyObject *pStr = (inDefault != NULL) ? PyObject_Str(inDefault) : NULL;
+			const char *str = (pStr != NULL) ? PyString_AsString(pStr) : NULL;
+			AllocateValueString_(ip, (str != NULL) ? str : "", outValue);
+			Py_XDECREF(pStr);
+			break;
+		}
+	}
+	PyErr_Clear();
+}
+
+// ---------------------------------------------------------------------------------
+//		 GetFuncKind
+// ---------------------------------------------------------------------------------
+// Determines how a callable is called: generator functions are started once and
+// resumed on each call, classes with a __call__ method are instantiated once and
+// their instance is called. Other classes and callables are called on each call.
+// Must be called with the GIL held.
+
+static FuncKind
+GetFuncKind(
+	PyObject*	inFunc)
+{
+	if (PyType_Check(inFunc))
+		return (((PyTypeObject*)inFunc)->tp_call != NULL) ? kFuncClass : kFuncPlain;
+	
+	PyObject *pCode = PyObject_GetAttrString(inFunc, "__code__");
+	PyObject *pFlags = (pCode != NULL) ? PyObject_GetAttrString(pCode, "co_flags") : NULL;
+	long flags = (pFlags != NULL) ? PyInt_AsLong(pFlags) : 0;
+	
+	Py_XDECREF(pCode);
+	Py_XDECREF(pFlags);
+	PyErr_Clear();
+	
+	return (flags != -1 && (flags & CO_GENERATOR) != 0) ? kFuncGenerator : kFuncPlain;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReadFunctionArgs
+// ---------------------------------------------------------------------------------
+// Creates the arguments of an actor from the code object of a python function: its
+// positional arguments, followed by its keyword-only arguments. Arguments collected
+// by *args and **kwargs are left out, and so are the first inSkip arguments, such as
+// the self argument of methods. Returns the number of arguments.
+
+static int
+ReadFunctionArgs(
+	IsadoraParameters*	ip,
+	PluginInfo*			info,
+	PyObject*			inFunc,
+	int					inSkip)
+{
+	// Callables that are not python functions, such as classes and builtins, don't
+	// have a code object and get no arguments
+	PyObject *pCode = PyObject_GetAttrString(inFunc, "__code__");
+	PyObject *pNames = (pCode != NULL) ? PyObject_GetAttrString(pCode, "co_varnames") : NULL;
+	PyObject *pNumPositional = (pCode != NULL) ? PyObject_GetAttrString(pCode, "co_argcount") : NULL;
+	PyObject *pNumKeywords = (pCode != NULL) ? PyObject_GetAttrString(pCode, "co_kwonlyargcount") : NULL;
+	PyErr_Clear();
+	
+	int numPositional = (pNumPositional != NULL) ? (int)PyInt_AsLong(pNumPositional) : 0;
+	int numKeywords = (pNumKeywords != NULL) ? (int)PyInt_AsLong(pNumKeywords) : 0;
+	int size = numPositional + numKeywords;
+	if (pNames == NULL || !PyTuple_Check(pNames) || numPositional < inSkip || numKeywords < 0 || size > PyTuple_GET_SIZE(pNames))
+		size = numPositional = numKeywords = inSkip = 0;
+	numPositional -= inSkip;
+	size -= inSkip;
+	
+	PyObject *pDefaults = PyObject_GetAttrString(inFunc, "__defaults__");
+	PyObject *pKwDefaults = PyObject_GetAttrString(inFunc, "__kwdefaults__");
+	PyObject *pAnnotations = PyObject_GetAttrString(inFunc, "__annotations__");
+	PyErr_Clear();
+	
+	// the defaults belong to the last positional arguments
+	int numDefaults = (pDefaults != NULL && PyTuple_Check(pDefaults)) ? (int)PyTuple_GET_SIZE(pDefaults) : 0;
+	int firstDefault = numPositional - numDefaults;
+	
+	// the names are stored after the arguments
+	size_t namesSize = 0;
+	int i;
+	for (i=0; i<size; i++)
+	{
+		PyObject *pName = PyTuple_GET_ITEM(pNames, inSkip + i);
+		const char *name = PyString_Check(pName) ? PyString_AsString(pName) : NULL;
+		namesSize += (name != NULL) ? strlen(name)+1 : 1;
+	}
+	char *names = ReserveArgs(info, size, namesSize);
+	
+	for (i=0; i<size; i++)
+	{
+		PyObject *pName = PyTuple_GET_ITEM(pNames, inSkip + i);
+		const char *name = PyString_Check(pName) ? PyString_AsString(pName) : NULL;
+		if (name == NULL)
+			name = "";
+		
+		PyObject *pDefault = NULL;
+		if (i < numPositional && i >= firstDefault)
+		{
+			pDefault = PyTuple_GET_ITEM(pDefaults, i - firstDefault);
+			Py_INCREF(pDefault);
+		}
+		else if (i >= numPositional && pKwDefaults != NULL && PyDict_Check(pKwDefaults))
+			PyDict_GetItemStringRef(pKwDefaults, name, &pDefault);
+		
+		PyObject *pAnnotation = NULL;
+		if (pAnnotations != NULL && PyDict_Check(pAnnotations))
+			PyDict_GetItemStringRef(pAnnotations, name, &pAnnotation);
+		
+		info->mArgs[i].name = names;
+		strcpy(names, name);
+		names += strlen(name)+1;
+		InitArgValue(ip, name, pAnnotation, pDefault, kString, &info->mArgs[i].value);
+		Py_XDECREF(pDefault);
+		Py_XDECREF(pAnnotation);
+	}
+	info->mNumKeywordArgs = numKeywords;
+	
+	Py_XDECREF(pCode);
+	Py_XDECREF(pNames);
+	Py_XDECREF(pNumPositional);
+	Py_XDECREF(pNumKeywords);
+	Py_XDECREF(pDefaults);
+	Py_XDECREF(pKwDefaults);
+	Py_XDECREF(pAnnotations);
+	PyErr_Clear();
+	
+	return size;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FindDiscoveredFunc
+// ---------------------------------------------------------------------------------
+// Looks up the arguments of the function of an actor, discovered earlier by this or
+// another actor. The watched files of the actor must be up to date; an entry is only
+// returned if the source files of the module have not changed since it was stored.
+
+static DiscoveredFunc*
+FindDiscoveredFunc(
+	PluginInfo* info )
+{
+	DiscoveredFunc **link = &sDiscoveredFuncs;
+	while (*link != NULL)
+	{
+		DiscoveredFunc *entry = *link;
+		if (strcmp(entry->path, info->mPath != NULL ? info->mPath : "") == 0
+			&& strcmp(entry->file, info->mFile) == 0 && strcmp(entry->func, info->mFunc) == 0)
+		{
+			if (entry->numFiles != info->mNumWatchedFiles)
+				return NULL;
+			
+			unsigned int i;
+			for (i=0; i<entry->numFiles; i++)
+			{
+				const WatchedFile *watched = &info->mWatchedFiles[i];
+				if (strcmp(entry->files[i].path, watched->path) != 0
+					|| entry->files[i].mtime != watched->mtime || entry->files[i].size != watched->size)
+					return NULL;
+			}
+			
+			// Keep the most recently used entries at the front
+			*link = entry->next;
+			entry->next = sDiscoveredFuncs;
+			sDiscoveredFuncs = entry;
+			return entry;
+		}
+		link = &entry->next;
+	}
+	return NULL;
+}
+
+// ---------------------------------------------------------------------------------
+//		 StoreDiscoveredFunc
+// ---------------------------------------------------------------------------------
+// Remembers the discovered arguments of the function of an actor, together with the
+// source files of its module. Replaces an outdated entry for the same function, and
+// drops the least recently used entry when there are too many.
+
+static void
+StoreDiscoveredFunc(
+	PluginInfo* info )
+{
+	const char *path = (info->mPath != NULL) ? info->mPath : "";
+	
+	unsigned int count = 0;
+	DiscoveredFunc **link = &sDiscoveredFuncs;
+	while (*link != NULL)
+	{
+		DiscoveredFunc *entry = *link;
+		if ((strcmp(entry->path, path) == 0 && strcmp(entry->file, info->mFile) == 0
+			&& strcmp(entry->func, info->mFunc) == 0) || count == kMaxDiscoveredFuncs - 1)
+		{
+			*link = entry->next;
+			entry->next = NULL;
+			FreeDiscoveredFuncs(entry);
+			continue;
+		}
+		count++;
+		link = &entry->next;
+	}
+	
+	DiscoveredFunc *entry = (DiscoveredFunc*) calloc(1, sizeof(DiscoveredFunc));
+	entry->path = CopyString(path);
+	entry->file = CopyString(info->mFile);
+	entry->func = CopyString(info->mFunc);
+	
+	unsigned int i;
+	entry->numFiles = info->mNumWatchedFiles;
+	entry->files = (WatchedFile*) malloc((entry->numFiles > 0 ? entry->numFiles : 1) * sizeof(WatchedFile));
+	for (i=0; i<entry->numFiles; i++)
+	{
+		entry->files[i] = info->mWatchedFiles[i];
+		entry->files[i].path = CopyString(info->mWatchedFiles[i].path);
+	}
+	
+	entry->numArgs = info->mNumArgs;
+	entry->numKeywordArgs = info->mNumKeywordArgs;
+	entry->argNames = (char**) malloc((entry->numArgs > 0 ? entry->numArgs : 1) * sizeof(char*));
+	entry->args = (ArgValue*) calloc(entry->numArgs > 0 ? entry->numArgs : 1, sizeof(ArgValue));
+	for (i=0; i<entry->numArgs; i++)
+	{
+		entry->argNames[i] = CopyString(info->mArgs[i].name);
+		entry->args[i].value = info->mArgs[i].value;
+		entry->args[i].present = true;
+		if (entry->args[i].value.type == kString)
+		{
+			entry->args[i].value.u.str = NULL;
+			entry->args[i].str = CopyString(info->mArgs[i].value.u.str->strData);
+		}
+	}
+	
+	entry->next = sDiscoveredFuncs;
+	sDiscoveredFuncs = entry;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CopyDiscoveredArgs
+// ---------------------------------------------------------------------------------
+// Creates the arguments of an actor from a discovered function. Returns the number
+// of arguments.
+
+static int
+CopyDiscoveredArgs(
+	IsadoraParameters*	ip,
+	PluginInfo*			info,
+	DiscoveredFunc*		entry)
+{
+	size_t namesSize = 0;
+	unsigned int i;
+	for (i=0; i<entry->numArgs; i++)
+		namesSize += strlen(entry->argNames[i])+1;
+	char *names = ReserveArgs(info, entry->numArgs, namesSize);
+	
+	for (i=0; i<entry->numArgs; i++)
+	{
+		info->mArgs[i].name = names;
+		strcpy(names, entry->argNames[i]);
+		names += strlen(entry->argNames[i])+1;
+		info->mArgs[i].value = entry->args[i].value;
+		if (entry->args[i].value.type == kString)
+			AllocateValueString_(ip, entry->args[i].str, &info->mArgs[i].value);
+	}
+	
+	info->mNumKeywordArgs = entry->numKeywordArgs;
+	return (int)entry->numArgs;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CompilePythonCode
+// ---------------------------------------------------------------------------------
+// Compiles the inline code of an actor, as an expression if possible, and otherwise
+// as statements. Returns the code object, or NULL with the error in outError,
+// allocated with malloc. Must be called with the GIL held.
+
+static PyObject*
+CompilePythonCode(
+	const char*	inCode,
+	char**		outError)
+{
+	PyObject *pCode = Py_CompileString((char*)inCode, "<code>", Py_eval_input);
+	if (pCode == NULL)
+	{
+		PyErr_Clear();
+		pCode = Py_CompileString((char*)inCode, "<code>", Py_file_input);
+	}
+	if (pCode == NULL)
+		*outError = FetchPythonError();
+
+	return pCode;
+}
+
+// ---------------------------------------------------------------------------------
+//		 NewCodeGlobals
+// ---------------------------------------------------------------------------------
+// Returns a new dict with the global variables of inline code: the builtins and the
+// math module. Must be called with the GIL held.
+
+static PyObject*
+NewCodeGlobals()
+{
+	PyObject *pGlobals = PyDict_New();
+	PyDict_SetItemString(pGlobals, "__builtins__", PyEval_GetBuiltins());
+
+	PyObject *pMath = PyImport_ImportModule("math");
+	if (pMath != NULL)
+	{
+		PyDict_SetItemString(pGlobals, "math", pMath);
+		Py_DECREF(pMath);
+	}
+	PyErr_Clear();
+
+	return pGlobals;
+}
+
+// ---------------------------------------------------------------------------------
+//		 SymbolIs
+// ---------------------------------------------------------------------------------
+// Calls one of the boolean methods of a symtable.Symbol.
+
+static bool
+SymbolIs(
+	PyObject*	inSymbol,
+	const char*	inMethod)
+{
+	PyObject *pResult = PyObject_CallMethod(inSymbol, (char*)inMethod, NULL);
+	bool result = (pResult != NULL && PyObject_IsTrue(pResult) == 1);
+	Py_XDECREF(pResult);
+	return result;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CollectCodeNames
+// ---------------------------------------------------------------------------------
+// Walks a symtable.SymbolTable and its nested scopes (functions, lambdas, classes and
+// comprehensions). Adds the global names that are used to ioUsed, and the global names
+// that are assigned or imported to ioAssigned, each name once. In a nested scope the
+// global names are those that are not local to it or to an enclosing function, which
+// are listed in inBound.
+
+static void
+CollectCodeNames(
+	PyObject*	inTable,
+	PyObject*	inBound,
+	bool		inTop,
+	PyObject*	ioUsed,
+	PyObject*	ioAssigned)
+{
+	PyObject *pType = PyObject_CallMethod(inTable, "get_type", NULL);
+	bool function = (pType != NULL && PyString_Check(pType) && strcmp(PyString_AsString(pType), "function") == 0);
+	Py_XDECREF(pType);
+	
+	// A function adds its locals to a copy of the bound names, for its nested scopes
+	PyObject *pBound = function ? PySequence_List(inBound) : inBound;
+	PyObject *pSymbols = PyObject_CallMethod(inTable, "get_symbols", NULL);
+	PyErr_Clear();
+	
+	Py_ssize_t i, size = (pSymbols != NULL && PyList_Check(pSymbols)) ? PyList_GET_SIZE(pSymbols) : 0;
+	for (i=0; i<size; i++)
+	{
+		PyObject *pSymbol = PyList_GET_ITEM(pSymbols, i);
+		PyObject *pName = PyObject_CallMethod(pSymbol, "get_name", NULL);
+		if (pName == NULL || !PyString_Check(pName))
+		{
+			Py_XDECREF(pName);
+			continue;
+		}
+		
+		bool global = inTop || SymbolIs(pSymbol, "is_global")
+			|| (SymbolIs(pSymbol, "is_free") && PySequence_Contains(inBound, pName) == 0);
+		if (global && SymbolIs(pSymbol, "is_referenced") && PySequence_Contains(ioUsed, pName) == 0)
+			PyList_Append(ioUsed, pName);
+		if (global && (SymbolIs(pSymbol, "is_assigned") || SymbolIs(pSymbol, "is_imported"))
+			&& (inTop || SymbolIs(pSymbol, "is_declared_global")) && PySequence_Contains(ioAssigned, pName) == 0)
+			PyList_Append(ioAssigned, pName);
+		if (function && pBound != NULL && SymbolIs(pSymbol, "is_local"))
+			PyList_Append(pBound, pName);
+		Py_DECREF(pName);
+	}
+	
+	PyObject *pChildren = PyObject_CallMethod(inTable, "get_children", NULL);
+	PyErr_Clear();
+	size = (pChildren != NULL && PyList_Check(pChildren) && pBound != NULL) ? PyList_GET_SIZE(pChildren) : 0;
+	for (i=0; i<size; i++)
+		CollectCodeNames(PyList_GET_ITEM(pChildren, i), pBound, false, ioUsed, ioAssigned);
+	
+	Py_XDECREF(pChildren);
+	Py_XDECREF(pSymbols);
+	if (function)
+		Py_XDECREF(pBound);
+	PyErr_Clear();
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReadCodeArgs
+// ---------------------------------------------------------------------------------
+// Creates the arguments of an actor from its inline code: the global names the code
+// uses, also in comprehensions, lambdas and functions, without assigning or
+// importing them, other than its globals and the builtins. They are all passed by
+// name. Arguments without a type suffix in their name are floats. Returns the number
+// of arguments.
+
+static int
+ReadCodeArgs(
+	IsadoraParameters*	ip,
+	PluginInfo*			info,
+	PyObject*			inGlobals)
+{
+	PyObject *pBuiltins;
+	PyDict_GetItemStringRef(inGlobals, "__builtins__", &pBuiltins);
+	PyObject *pSymtable = PyImport_ImportModule("symtable");
+	PyObject *pTable = (pSymtable != NULL) ? PyObject_CallMethod(pSymtable, "symtable", "sss", info->mCode, "<code>", "exec") : NULL;
+	PyObject *pUsed = PyList_New(0);
+	PyObject *pAssigned = PyList_New(0);
+	PyObject *pBound = PyList_New(0);
+	PyObject *pNames = PyList_New(0);
+	PyErr_Clear();
+	
+	if (pTable != NULL)
+		CollectCodeNames(pTable, pBound, true, pUsed, pAssigned);
+	
+	Py_ssize_t i, size = PyList_GET_SIZE(pUsed);
+	for (i=0; i<size; i++)
+	{
+		PyObject *pName = PyList_GET_ITEM(pUsed, i);
+		if (PySequence_Contains(pAssigned, pName) == 0
+			&& PyDict_Contains(inGlobals, pName) == 0
+			&& (pBuiltins == NULL || !PyDict_Check(pBuiltins) || PyDict_Contains(pBuiltins, pName) == 0))
+		{
+			PyList_Append(pNames, pName);
+		}
+	}
+	PyErr_Clear();
+	
+	// the names are stored after the arguments
+	size = PyList_GET_SIZE(pNames);
+	size_t namesSize = 0;
+	for (i=0; i<size; i++)
+		namesSize += strlen(PyString_AsString(PyList_GET_ITEM(pNames, i)))+1;
+	char *names = ReserveArgs(info, (unsigned int)size, namesSize);
+	
+	for (i=0; i<size; i++)
+	{
+		const char *name = PyString_AsString(PyList_GET_ITEM(pNames, i));
+		info->mArgs[i].name = names;
+		strcpy(names, name);
+		names += strlen(name)+1;
+		InitArgValue(ip, name, NULL, NULL, kFloat, &info->mArgs[i].value);
+	}
+	info->mNumKeywordArgs = (unsigned int)size;
+	
+	Py_XDECREF(pSymtable);
+	Py_XDECREF(pTable);
+	Py_DECREF(pUsed);
+	Py_DECREF(pAssigned);
+	Py_DECREF(pBound);
+	Py_DECREF(pNames);
+	Py_XDECREF(pBuiltins);
+	PyErr_Clear();
+	
+	return (int)size;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReadWorkerSource
+// ---------------------------------------------------------------------------------
+// Returns the source of izzy_worker.py, which defines the WorkerProcess class that
+// sends the calls of the process mode to a python process, in a string allocated
+// with malloc, or NULL if it was not found. On Windows it is a resource of the
+// plugin; on MacOS it is in the Resources folder of the plugin bundle, and on other
+// systems it is next to the plugin.
+
+static char*
+ReadWorkerSource()
+{
+#if TARGET_OS_WIN32
+	HMODULE module = NULL;
+	if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+			(LPCSTR) &ReadWorkerSource, &module))
+		return NULL;
+	
+	HRSRC resource = FindResourceA(module, MAKEINTRESOURCEA(IDR_WORKER_PROCESS), (LPCSTR) RT_RCDATA);
+	HGLOBAL data = (resource != NULL) ? LoadResource(module, resource) : NULL;
+	const char *bytes = (data != NULL) ? (const char*) LockResource(data) : NULL;
+	if (bytes == NULL)
+		return NULL;
+	
+	DWORD size = SizeofResource(module, resource);
+	char *source = (char*) malloc(size + 1);
+	memcpy(source, bytes, size);
+	source[size] = 0;
+	return source;
+#else
+	Dl_info dlInfo;
+	if (dladdr((void*) &ReadWorkerSource, &dlInfo) == 0 || dlInfo.dli_fname == NULL)
+		return NULL;
+	
+	const char *slash = strrchr(dlInfo.dli_fname, '/');
+	size_t dirLen = (slash != NULL) ? (size_t)(slash - dlInfo.dli_fname) : 0;
+	char *path = (char*) malloc(dirLen + 64);
+	memcpy(path, dlInfo.dli_fname, dirLen);
+	#if TARGET_OS_MAC
+	// the plugin is in Contents/MacOS of the bundle
+	strcpy(path + dirLen, (dirLen > 0) ? "/../Resources/izzy_worker.py" : "../Resources/izzy_worker.py");
+	#else
+	strcpy(path + dirLen, (dirLen > 0) ? "/izzy_worker.py" : "izzy_worker.py");
+	#endif
+	
+	FILE *file = fopen(path, "rb");
+	free(path);
+	if (file == NULL)
+		return NULL;
+	
+	char *source = NULL;
+	long size = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+	if (size >= 0 && fseek(file, 0, SEEK_SET) == 0)
+	{
+		source = (char*) malloc(size + 1);
+		if (fread(source, 1, size, file) == (size_t) size)
+			source[size] = 0;
+		else
+		{
+			free(source);
+			source = NULL;
+		}
+	}
+	fclose(file);
+	return source;
+#endif
+}
+
+// ---------------------------------------------------------------------------------
+//		 NewWorkerProcess
+// ---------------------------------------------------------------------------------
+// Returns a new WorkerProcess for the function of an actor. The class is defined
+// once in each interpreter, by running izzy_worker.py as the _izzy_worker module.
+// Returns NULL with a python error set if it could not be created. Must be called
+// with the GIL held.
+
+static PyObject*
+NewWorkerProcess(
+	PluginInfo*	info)
+{
+	PyObject *pModule = PyImport_AddModule("_izzy_worker");
+	PyObject *pDict = (pModule != NULL) ? PyModule_GetDict(pModule) : NULL;
+	if (pDict == NULL)
+		return NULL;
+	
+	PyObject *pClass;
+	if (PyDict_GetItemStringRef(pDict, "WorkerProcess", &pClass) == 0)
+	{
+		char *source = ReadWorkerSource();
+		if (source == NULL)
+		{
+			PyErr_SetString(PyExc_RuntimeError, "izzy_worker.py was not found with the plugin");
+			return NULL;
+		}
+		
+		// The worker process runs the same source as its main script
+		PyObject *pResult = PyRun_String(source, Py_file_input, pDict, pDict);
+		PyObject *pSource = (pResult != NULL) ? PyString_FromString(source) : NULL;
+		free(source);
+		if (pSource == NULL || PyDict_SetItemString(pDict, "SOURCE", pSource) != 0)
+		{
+			Py_XDECREF(pResult);
+			Py_XDECREF(pSource);
+			return NULL;
+		}
+		Py_DECREF(pResult);
+		Py_DECREF(pSource);
+		PyDict_GetItemStringRef(pDict, "WorkerProcess", &pClass);
+	}
+	
+	PyObject *pWorker = (pClass != NULL) ? PyObject_CallFunction(pClass, "sss", (info->mPath != NULL) ? info->mPath : "", info->mFile, info->mFunc) : NULL;
+	Py_XDECREF(pClass);
+	return pWorker;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FindPythonFunc
+// ---------------------------------------------------------------------------------
+// Looks up the function of an actor, or compiles its inline code, and creates its
+// arguments.
+
+static void
+FindPythonFunc(
+	IsadoraParameters*	ip,
+	PluginInfo* info )
+{	
+	PyObject *pModule = NULL, *pDict, *pFunc = NULL, *pWorker = NULL;
+	DiscoveredFunc *discovered = NULL;
+	char *error = NULL;
+	int size = 0, i;
+	
+	// NB: PyObjects returned by PyObject_*, PyNumber_*, PySequence_* or PyMapping_* functions must 
+	// be dererefereced using Py_DECREF, PyObjects returned by PyString_*, PyTuple_* etc must not!
+	// See https://docs.python.org/2/c-api/intro.html#reference-counts
+	
+	double start = GetSeconds();
+	
+	// Release the string values of the previous arguments
+	ClearArgs(ip, info);
+
+	info->mFuncFound = false;
+	info->mAnnotatedKind = kResultSingle;
+	info->mAnnotatedType = kString;
+	FreeValueOutputs(info->mAnnotatedOutputs, info->mNumAnnotatedOutputs);
+	info->mAnnotatedOutputs = NULL;
+	info->mNumAnnotatedOutputs = 0;
+
+	// Enter the python interpreter of the actor
+	PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+	
+	// Release the previously resolved function, once a running call of the actor is done
+	LockAsyncCall(info->mAsyncCall);
+	Py_CLEAR(info->mPyFunc);
+	Py_CLEAR(info->mPyModule);
+	Py_CLEAR(info->mArgTuple);
+	Py_CLEAR(info->mKwNames);
+	Py_CLEAR(info->mAsyncCall->func);
+	Py_CLEAR(info->mAsyncCall->kwNames);
+	Py_CLEAR(info->mAsyncCall->state);
+	Py_CLEAR(info->mStream);
+	info->mFuncKind = kFuncPlain;
+	info->mStateful = false;
+	info->mAsyncCall->funcKind = kFuncPlain;
+
+	bool inlineCode = (info->mCode != NULL && strlen(info->mCode) > 0);
+	if (!inlineCode && (info->mFile == NULL || strlen(info->mFile) == 0 || info->mFunc == NULL || strlen(info->mFunc) == 0))
+	{
+		UnlockAsyncCall(info->mAsyncCall);
+		LeavePythonInterpreter(info->mInterpreter, gstate);
+		UpdateResultType(ip, info->mActorInfoPtr);
+		return;
+	}
+	
+	if (inlineCode)
+	{
+		// Inline code is compiled once, and evaluated by each call
+		pFunc = CompilePythonCode(info->mCode, &error);
+	}
+	else if (info->mProcess)
+	{
+		// The module is only imported by the worker process; the arguments and return
+		// annotation are read from a stub function with the signature it reports
+		double importStart = GetSeconds();
+		pWorker = NewWorkerProcess(info);
+		pFunc = (pWorker != NULL) ? PyObject_CallMethod(pWorker, "start", "d", kWorkerStartSeconds) : NULL;
+		RecordTraceEvent("import", info->mActorInfoPtr, info->mFile, importStart, GetSeconds());
+		if (pFunc == NULL)
+			error = FetchPythonError();
+	}
+	else
+	{
+		// Load the module object from the specified directory
+		double importStart = GetSeconds();
+		pModule = ImportPythonModule(info->mPath, info->mFile);
+		RecordTraceEvent("import", info->mActorInfoPtr, info->mFile, importStart, GetSeconds());
+		if (pModule != NULL)
+		{
+			pDict = PyModule_GetDict(pModule);
+			if (pDict != NULL)
+			{
+				PyDict_GetItemStringRef(pDict, info->mFunc, &pFunc);
+			}
+		}
+	}
+	
+	info->mFuncFound = (pFunc != NULL && (inlineCode || PyCallable_Check(pFunc)));
+	
+	// Keep the module and function around for CallPythonFunc
+	if (info->mFuncFound)
+	{
+		Py_INCREF(pFunc);
+		info->mPyFunc = pFunc;
+		info->mPyModule = pModule;
+		pModule = NULL;
+		
+		Py_INCREF(pFunc);
+		info->mAsyncCall->func = pFunc;
+		
+		// The arguments and return value of a class are those of its __call__ method
+		info->mFuncKind = inlineCode ? kFuncCode : GetFuncKind(pFunc);
+		info->mAsyncCall->funcKind = info->mFuncKind;
+		info->mStateful = (info->mFuncKind != kFuncPlain);
+		PyObject *pSignature = (info->mFuncKind == kFuncClass) ? PyObject_GetAttrString(pFunc, "__call__") : NULL;
+		if (pSignature == NULL)
+		{
+			Py_INCREF(pFunc);
+			pSignature = pFunc;
+		}
+		
+		// In a stream, the type of the results is that of the elements of the return value
+		ReadReturnAnnotation(info, pSignature, info->mFuncKind == kFuncGenerator || info->mStreamMode != 0);
+		
+		if (pWorker != NULL)
+			WatchWorkerFiles(info, pWorker);
+		else
+			WatchModuleFiles(info);
+		
+		// Another actor may have inspected the same function already
+		discovered = (inlineCode || pWorker != NULL) ? NULL : FindDiscoveredFunc(info);
+		if (inlineCode)
+		{
+			// The globals of the code are kept between its calls
+			info->mAsyncCall->state = NewCodeGlobals();
+			size = ReadCodeArgs(ip, info, info->mAsyncCall->state);
+		}
+		else if (discovered != NULL)
+			size = CopyDiscoveredArgs(ip, info, discovered);
+		else
+			size = ReadFunctionArgs(ip, info, pSignature, (pSignature != pFunc) ? 1 : 0);
+		Py_DECREF(pSignature);
+		
+		// The keyword-only arguments are passed by name
+		if (info->mNumKeywordArgs > 0)
+		{
+			info->mKwNames = PyTuple_New(info->mNumKeywordArgs);
+			for (i=0; i<(int)info->mNumKeywordArgs; i++)
+				PyTuple_SetItem(info->mKwNames, i, PyString_FromString(info->mArgs[size - info->mNumKeywordArgs + i].name));
+			
+			Py_INCREF(info->mKwNames);
+			info->mAsyncCall->kwNames = info->mKwNames;
+		}
+		
+		// The calls go to the worker process, not to its stub
+		if (pWorker != NULL)
+		{
+			Py_DECREF(info->mPyFunc);
+			Py_INCREF(pWorker);
+			info->mPyFunc = pWorker;
+			Py_DECREF(info->mAsyncCall->func);
+			Py_INCREF(pWorker);
+			info->mAsyncCall->func = pWorker;
+			info->mFuncKind = kFuncProcess;
+			info->mAsyncCall->funcKind = kFuncProcess;
+			
+			// the process keeps the state of generators and classes
+			PyObject *pKind = PyObject_GetAttrString(pWorker, "kind");
+			info->mStateful = (pKind == NULL || !PyString_Check(pKind) || strcmp(PyString_AsString(pKind), "plain") != 0);
+			Py_XDECREF(pKind);
+		}
+	}
+	
+	info->mNumArgs = size;
+	
+	if (info->mFuncFound && discovered == NULL && !inlineCode && pWorker == NULL)
+		StoreDiscoveredFunc(info);
+	
+	// In map mode the first argument gets a text input for the list of its values
+	info->mMapType = (size > 0) ? info->mArgs[0].value.type : kString;
+	if (info->mMap && info->mMapType != kString)
+	{
+		info->mArgs[0].value.type = kString;
+		AllocateValueString_(ip, "", &info->mArgs[0].value);
+	}
+	
+	for (i=0; i<size; i++)
+	{
+		info->mArgs[i].convert = GetValueConverter(info->mArgs[i].value.type);
+		info->mArgs[i].dirty = true;
+	}
+	
+	Py_XDECREF(pModule);
+	Py_XDECREF(pFunc);
+	Py_XDECREF(pWorker);
+	
+	// Don't leave a failed import or lookup behind in the shared interpreter
+	PyErr_Clear();
+
+	UnlockAsyncCall(info->mAsyncCall);
+
+	// Leave the python interpreter
+	LeavePythonInterpreter(info->mInterpreter, gstate);
+	
+	UpdateResultType(ip, info->mActorInfoPtr);
+	
+	// Syntax errors in inline code, and failures to start a worker process or to
+	// find the function in it, are shown right away
+	if (error != NULL)
+	{
+		OutputPythonError(ip, info->mActorInfoPtr, error);
+		free(error);
+	}
+	
+	RecordTraceEvent("discover", info->mActorInfoPtr, info->mFunc, start, GetSeconds());
+	
+	return;
+}
+
+// ---------------------------------------------------------------------------------
+//		 PythonToString
+// ---------------------------------------------------------------------------------
+// Returns the string conversion of a python object in a string allocated with
+// malloc, or NULL with a python error set. Must be called with the GIL held.
+
+static char*
+PythonToString(
+	PyObject*		inObject)
+{
+	PyObject *pStr = PyObject_Str(inObject);
+	const char *str = (pStr != NULL) ? PyString_AsString(pStr) : NULL;
+	char *result = NULL;
+
+	if (str != NULL)
+	{
+		result = static_cast<char*>(malloc(strlen(str)+1));
+		strcpy(result, str);
+	}
+
+	Py_XDECREF(pStr);
+	return result;
+}
+
+// ---------------------------------------------------------------------------------
+//		 PythonToItem
+// ---------------------------------------------------------------------------------
+// Converts an element of a tuple or dict return value, keeping its python type:
+// numbers and booleans are converted directly, anything else is converted to text.
+// Returns false with a python error set if the value can not be converted. Must be
+// called with the GIL held.
+
+static bool
+PythonToItem(
+	PyObject*		inObject,
+	PythonResult*	outItem)
+{
+	if (PyBool_Check(inObject))
+	{
+		outItem->value.type = kBoolean;
+		outItem->value.u.ivalue = (inObject == Py_True);
+		return true;
+	}
+	if (PyInt_Check(inObject) || PyLong_Check(inObject))
+	{
+		// A number too large for an integer output is converted to text
+		bool clamped = false;
+		outItem->value.type = kInteger;
+		if (PythonToInt32(inObject, &outItem->value.u.ivalue, &clamped) && !clamped)
+			return true;
+		PyErr_Clear();
+	}
+	if (PyFloat_Check(inObject))
+	{
+		outItem->value.type = kFloat;
+		outItem->value.u.fvalue = (float) PyFloat_AsDouble(inObject);
+		return true;
+	}
+
+	outItem->value.type = kString;
+	outItem->str = PythonToString(inObject);
+	return (outItem->str != NULL);
+}
+
+// ---------------------------------------------------------------------------------
+//		 PythonToResult
+// ---------------------------------------------------------------------------------
+// Converts a return value of the given kind. Single values are converted to the
+// given type; numbers and booleans directly, without going through their string
+// representation. The elements of tuples and dicts are converted by PythonToItem.
+// Returns false with a python error set if the value can not be converted. Must be
+// called with the GIL held, and with outResult initialized to the given type.
+
+static bool
+PythonToResult(
+	PyObject*		inObject,
+	ResultKind		inKind,
+	ValueType		inType,
+	PythonResult*	outResult)
+{
+	if (inKind == kResultTuple)
+	{
+		PyObject *pSeq = PySequence_Fast(inObject, "the function did not return a tuple");
+		if (pSeq == NULL)
+			return false;
+
+		unsigned int i, size = (unsigned int) PySequence_Fast_GET_SIZE(pSeq);
+		outResult->items = (PythonResult*) calloc(size > 0 ? size : 1, sizeof(PythonResult));
+		bool converted = true;
+		for (i=0; i<size && converted; i++)
+		{
+			converted = PythonToItem(PySequence_Fast_GET_ITEM(pSeq, i), &outResult->items[i]);
+			outResult->numItems = i + 1;
+		}
+		Py_DECREF(pSeq);
+		return converted;
+	}
+
+	if (inKind == kResultDict)
+	{
+		if (!PyDict_Check(inObject))
+		{
+			PyErr_SetString(PyExc_TypeError, "the function did not return a dict");
+			return false;
+		}
+
+		PyObject *pKey, *pItem;
+		Py_ssize_t pos = 0, size = PyDict_Size(inObject);
+		bool converted = true;
+		outResult->items = (PythonResult*) calloc(size > 0 ? size : 1, sizeof(PythonResult));
+		
+		// Another thread may change the dict; without a GIL it is locked meanwhile, and
+		// the items are kept alive while they are converted
+#ifdef Py_GIL_DISABLED
+		Py_BEGIN_CRITICAL_SECTION(inObject);
+#endif
+		while (converted && (Py_ssize_t)outResult->numItems < size && PyDict_Next(inObject, &pos, &pKey, &pItem))
+		{
+			Py_INCREF(pKey);
+			Py_INCREF(pItem);
+			PythonResult *item = &outResult->items[outResult->numItems++];
+			item->key = PythonToString(pKey);
+			converted = (item->key != NULL && PythonToItem(pItem, item));
+			Py_DECREF(pKey);
+			Py_DECREF(pItem);
+		}
+#ifdef Py_GIL_DISABLED
+		Py_END_CRITICAL_SECTION();
+#endif
+		return converted;
+	}
+
+	switch (inType)
+	{
+	case kInteger:
+		return PythonToInt32(inObject, &outResult->value.u.ivalue, NULL);
+	case kFloat:
+		outResult->value.u.fvalue = (float) PyFloat_AsDouble(inObject);
+		return !(outResult->value.u.fvalue == -1.f && PyErr_Occurred());
+	case kBoolean:
+		outResult->value.u.ivalue = PyObject_IsTrue(inObject);
+		return (outResult->value.u.ivalue != -1);
+	default:
+		outResult->value.type = kString;
+		outResult->str = PythonToString(inObject);
+		return (outResult->str != NULL);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 FetchPythonError
+// ---------------------------------------------------------------------------------
+// Clears the current python error and returns its description in a string allocated
+// with malloc. Must be called with the GIL held.
+
+static char*
+FetchPythonError()
+{
+	PyObject *pErrType, *pErrValue, *pTraceback;
+	//pErrValue contains error message
+	//pTraceback contains stack snapshot and many other information
+	//(see python traceback structure)
+
+	PyErr_Fetch(&pErrType, &pErrValue, &pTraceback);
+
+	char *error = (pErrValue != NULL) ? PythonToString(pErrValue) : NULL;
+	if (error == NULL)
+	{
+		error = static_cast<char*>(malloc(strlen("unspecified error")+1));
+		strcpy(error, "unspecified error");
+	}
+
+	Py_XDECREF(pErrType);
+	Py_XDECREF(pErrValue);
+	Py_XDECREF(pTraceback);
+	PyErr_Clear();
+
+	return error;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CallWithArgs
+// ---------------------------------------------------------------------------------
+// Calls a python callable with a tuple of arguments, the last of which are passed by
+// the names in inKwNames. Returns the return value, or NULL with a python error set.
+// Must be called with the GIL held.
+//
+// On Python 3.8 and newer the items of the tuple are passed with the vectorcall
+// protocol, so the function never sees the tuple itself.
+
+static PyObject*
+CallWithArgs(
+	PyObject*		inFunc,
+	PyObject*		inArgs,
+	PyObject*		inKwNames)
+{
+	// The last arguments are passed by keyword
+	Py_ssize_t numArgs = PyTuple_GET_SIZE(inArgs);
+	Py_ssize_t numKeywords = (inKwNames != NULL) ? PyTuple_GET_SIZE(inKwNames) : 0;
+	if (numKeywords > numArgs)
+	{
+		inKwNames = NULL;
+		numKeywords = 0;
+	}
+
+#if PY_VERSION_HEX >= 0x03090000
+	PyObject *pValue = PyObject_Vectorcall(inFunc, PySequence_Fast_ITEMS(inArgs), numArgs - numKeywords, inKwNames);
+#elif PY_VERSION_HEX >= 0x03080000
+	PyObject *pValue = _PyObject_Vectorcall(inFunc, PySequence_Fast_ITEMS(inArgs), numArgs - numKeywords, inKwNames);
+#else
+	PyObject *pValue;
+	if (inKwNames == NULL)
+	{
+		pValue = PyObject_CallObject(inFunc, inArgs);
+	}
+	else
+	{
+		PyObject *pPositional = PyTuple_GetSlice(inArgs, 0, numArgs - numKeywords);
+		PyObject *pKwArgs = PyDict_New();
+		Py_ssize_t i;
+		for (i=0; i<numKeywords; i++)
+			PyDict_SetItem(pKwArgs, PyTuple_GET_ITEM(inKwNames, i), PyTuple_GET_ITEM(inArgs, numArgs - numKeywords + i));
+		pValue = PyObject_Call(inFunc, pPositional, pKwArgs);
+		Py_DECREF(pPositional);
+		Py_DECREF(pKwArgs);
+	}
+#endif
+
+	return pValue;
+}
+
+// ---------------------------------------------------------------------------------
+//		 InvokeFunction
+// ---------------------------------------------------------------------------------
+// Calls a python function with a tuple of arguments, and returns a new reference to
+// its return value, or NULL with a python error set. Must be called with the GIL held.
+//
+// Generator functions and classes are called through the state in ioState, which is
+// created by the first call. A generator is started with the arguments and returns
+// its first value; after that the argument tuple is sent to it, and the value it
+// yields next is returned. When it has finished or raised an error it is started
+// again by the next call. A class is instantiated without arguments, and the
+// instance is called with the arguments. Inline code is evaluated with its globals
+// in ioState, and the arguments as local variables.
+
+static PyObject*
+InvokeFunction(
+	PyObject*		inFunc,
+	FuncKind		inFuncKind,
+	PyObject**		ioState,
+	PyObject*		inArgs,
+	PyObject*		inKwNames)
+{
+	PyObject *pValue = NULL;
+	switch (inFuncKind)
+	{
+		case kFuncGenerator:
+			if (*ioState == NULL)
+			{
+				*ioState = CallWithArgs(inFunc, inArgs, inKwNames);
+				pValue = (*ioState != NULL) ? PyIter_Next(*ioState) : NULL;
+			}
+			else
+			{
+				pValue = PyObject_CallMethod(*ioState, "send", "(O)", inArgs);
+			}
+			if (pValue == NULL)
+			{
+				Py_CLEAR(*ioState);
+				if (!PyErr_Occurred() || PyErr_ExceptionMatches(PyExc_StopIteration))
+				{
+					PyErr_Clear();
+					PyErr_SetString(PyExc_StopIteration, "the generator has finished");
+				}
+			}
+			break;
+		
+		case kFuncClass:
+			if (*ioState == NULL)
+				*ioState = PyObject_CallObject(inFunc, NULL);
+			pValue = (*ioState != NULL) ? CallWithArgs(*ioState, inArgs, inKwNames) : NULL;
+			break;
+		
+		case kFuncCode:
+		{
+			if (*ioState == NULL)
+				*ioState = NewCodeGlobals();
+			
+			// All arguments of inline code are passed by name, as globals of the code,
+			// so nested scopes such as comprehensions find them
+			PyObject *pGlobals = *ioState;
+			Py_ssize_t i, numArgs = PyTuple_GET_SIZE(inArgs);
+			for (i=0; inKwNames != NULL && i < PyTuple_GET_SIZE(inKwNames) && i < numArgs; i++)
+				PyDict_SetItem(pGlobals, PyTuple_GET_ITEM(inKwNames, i), PyTuple_GET_ITEM(inArgs, i));
+			if (PyDict_DelItemString(pGlobals, "result") != 0)
+				PyErr_Clear();
+#if PY_MAJOR_VERSION >= 3
+			pValue = PyEval_EvalCode(inFunc, pGlobals, pGlobals);
+#else
+			pValue = PyEval_EvalCode((PyCodeObject*)inFunc, pGlobals, pGlobals);
+#endif
+			// Statements return None; their result is the result variable
+			PyObject *pResult = NULL;
+			if (pValue == Py_None)
+				PyDict_GetItemStringRef(pGlobals, "result", &pResult);
+			if (pResult != NULL)
+			{
+				Py_DECREF(pValue);
+				pValue = pResult;
+			}
+			break;
+		}
+		
+		default:
+			pValue = CallWithArgs(inFunc, inArgs, inKwNames);
+			break;
+	}
+
+	return pValue;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CallPythonObject
+// ---------------------------------------------------------------------------------
+// Calls a python function with a tuple of arguments through InvokeFunction, and
+// converts its return value to the given kind and type. Returns NULL on success, or
+// the error string allocated with malloc. Must be called with the GIL held.
+
+static char*
+CallPythonObject(
+	PyObject*		inFunc,
+	FuncKind		inFuncKind,
+	PyObject**		ioState,
+	PyObject*		inArgs,
+	PyObject*		inKwNames,
+	ResultKind		inKind,
+	ValueType		inType,
+	PythonResult*	outResult,
+	double*			outPythonTime)
+{
+	char *error = NULL;
+	memset(outResult, 0, sizeof(PythonResult));
+	outResult->value.type = inType;
+
+	double start = (outPythonTime != NULL) ? GetSeconds() : 0;
+
+	PyObject *pValue = InvokeFunction(inFunc, inFuncKind, ioState, inArgs, inKwNames);
+
+	if (outPythonTime != NULL)
+		*outPythonTime = (GetSeconds() - start) * 1000;
+	bool converted = false;
+	if (pValue != NULL)
+	{
+		converted = PythonToResult(pValue, inKind, inType, outResult);
+		Py_DECREF(pValue);
+	}
+	if (!converted)
+	{
+		FreePythonResult(outResult);
+		error = FetchPythonError();
+	}
+	PyErr_Clear();
+
+	return error;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ParseListValue
+// ---------------------------------------------------------------------------------
+// Converts a value of a list in text to a python object of the given type. Returns a
+// new reference, or NULL with a ValueError set if the text is not a number of that
+// type. Must be called with the GIL held.
+
+static PyObject*
+ParseListValue(
+	const char*		inText,
+	size_t			inLength,
+	ValueType		inType)
+{
+	if (inType == kString)
+		return PyString_FromStringAndSize(inText, inLength);
+
+	char number[64];
+	char *end = number;
+	if (inLength > 0 && inLength < sizeof(number))
+	{
+		memcpy(number, inText, inLength);
+		number[inLength] = 0;
+
+		switch (inType)
+		{
+			case kInteger:
+			{
+				errno = 0;
+				long value = strtol(number, &end, 10);
+				if (*end == 0 && errno == 0)
+					return PyInt_FromLong(value);
+				break;
+			}
+
+			case kBoolean:
+			{
+				// only whole words, in any case; everything else must be a number
+				char *c;
+				for (c = number; *c != 0; c++)
+					*c = (char) tolower((unsigned char) *c);
+				if (strcmp(number, "true") == 0 || strcmp(number, "on") == 0)
+					return PyBool_FromLong(1);
+				if (strcmp(number, "false") == 0 || strcmp(number, "off") == 0)
+					return PyBool_FromLong(0);
+				double value = strtod(number, &end);
+				if (*end == 0)
+					return PyBool_FromLong(value != 0);
+				break;
+			}
+
+			default:
+			{
+				double value = strtod(number, &end);
+				if (*end == 0)
+					return PyFloat_FromDouble(value);
+				break;
+			}
+		}
+	}
+
+	const char *typeName = (inType == kInteger) ? "an integer" : (inType == kBoolean) ? "a boolean" : "a number";
+	char message[128];
+	snprintf(message, sizeof(message), "'%.*s' is not %s", (int) (inLength < 64 ? inLength : 64), inText, typeName);
+	PyErr_SetString(PyExc_ValueError, message);
+	return NULL;
+}
+
+// ---------------------------------------------------------------------------------
+//		 MapPythonObject
+// ---------------------------------------------------------------------------------
+// Calls a python function through CallPythonObject for each value of a list, which
+// replaces the first argument in the tuple of arguments. The list is split at the
+// separator and its values are converted to the given type without going through
+// python; spaces around the values are ignored. The results are converted to text,
+// and joined with the separator into the string of a single result. Returns NULL on
+// success, or the error string allocated with malloc. Must be called with the GIL
+// held.
+
+static char*
+MapPythonObject(
+	PyObject*		inFunc,
+	FuncKind		inFuncKind,
+	PyObject**		ioState,
+	PyObject*		inArgs,
+	PyObject*		inKwNames,
+	const char*		inList,
+	const char*		inSeparator,
+	ValueType		inType,
+	PythonResult*	outResult,
+	double*			outPythonTime)
+{
+	char *error = NULL;
+	memset(outResult, 0, sizeof(PythonResult));
+	outResult->value.type = kString;
+
+	size_t separatorLength = strlen(inSeparator);
+	size_t length = 0, capacity = 256;
+	char *joined = (char*) malloc(capacity);
+	joined[0] = 0;
+
+	double python = 0;
+	Py_ssize_t i, numArgs = PyTuple_GET_SIZE(inArgs);
+	PyObject *pArgs = NULL;
+	unsigned int index = 0;
+
+	// An empty text is an empty list
+	const char *value = (inList != NULL && inList[0] != 0 && numArgs > 0) ? inList : NULL;
+	while (value != NULL && error == NULL)
+	{
+		const char *end = strstr(value, inSeparator);
+		const char *next = (end != NULL) ? end + separatorLength : NULL;
+		if (end == NULL)
+			end = value + strlen(value);
+		while (value < end && (*value == ' ' || *value == '\t'))
+			value++;
+		while (end > value && (end[-1] == ' ' || end[-1] == '\t'))
+			end--;
+
+		// The function may have kept a reference to the previous tuple
+		if (pArgs == NULL || Py_REFCNT(pArgs) != 1)
+		{
+			Py_XDECREF(pArgs);
+			pArgs = PyTuple_New(numArgs);
+			for (i=1; i<numArgs; i++)
+			{
+				Py_INCREF(PyTuple_GET_ITEM(inArgs, i));
+				PyTuple_SET_ITEM(pArgs, i, PyTuple_GET_ITEM(inArgs, i));
+			}
+		}
+		PythonResult result;
+		memset(&result, 0, sizeof(result));
+		double time = 0;
+		PyObject *pValue = ParseListValue(value, end - value, inType);
+		if (pValue != NULL)
+		{
+			PyTuple_SetItem(pArgs, 0, pValue);
+			error = CallPythonObject(inFunc, inFuncKind, ioState, pArgs, inKwNames, kResultSingle, kString, &result, &time);
+			python += time;
+		}
+		else
+		{
+			error = FetchPythonError();
+			PyErr_Clear();
+		}
+
+		if (error == NULL)
+		{
+			size_t resultLength = strlen(result.str);
+			if (length + separatorLength + resultLength + 1 > capacity)
+			{
+				capacity = (length + separatorLength + resultLength + 1) * 2;
+				joined = (char*) realloc(joined, capacity);
+			}
+			if (index > 0)
+			{
+				memcpy(joined + length, inSeparator, separatorLength);
+				length += separatorLength;
+			}
+			memcpy(joined + length, result.str, resultLength + 1);
+			length += resultLength;
+		}
+		else
+		{
+			// Tell which value of the list failed
+			char *valueError = (char*) malloc(strlen(error) + 32);
+			sprintf(valueError, "value %u: %s", index + 1, error);
+			free(error);
+			error = valueError;
+		}
+		FreePythonResult(&result);
+
+		value = next;
+		index++;
+	}
+	Py_XDECREF(pArgs);
+
+	if (outPythonTime != NULL)
+		*outPythonTime = python;
+
+	if (error == NULL)
+		outResult->str = joined;
+	else
+		free(joined);
+
+	return error;
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputResultItem
+// ---------------------------------------------------------------------------------
+// Sends an element of a tuple or dict return value to a value output, converting it
+// to the type of the output.
+
+static void
+OutputResultItem(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	PropertyIndex		inPropertyIndex1,
+	ValueType			inType,
+	const PythonResult*	inItem)
+{
+	Value val;
+	char str[32];
+
+	val.type = inType;
+	switch (inType)
+	{
+	case kInteger:
+	case kBoolean:
+		if (inItem->value.type == kFloat)
+			val.u.ivalue = (SInt32) inItem->value.u.fvalue;
+		else if (inItem->value.type == kString)
+			val.u.ivalue = atoi(inItem->str);
+		else
+			val.u.ivalue = inItem->value.u.ivalue;
+		if (inType == kBoolean)
+			val.u.ivalue = (val.u.ivalue != 0);
+		break;
+	case kFloat:
+		if (inItem->value.type == kFloat)
+			val.u.fvalue = inItem->value.u.fvalue;
+		else if (inItem->value.type == kString)
+			val.u.fvalue = (float) atof(inItem->str);
+		else
+			val.u.fvalue = (float) inItem->value.u.ivalue;
+		break;
+	default:
+		if (inItem->value.type == kString)
+			AllocateValueString_(ip, inItem->str, &val);
+		else
+		{
+			if (inItem->value.type == kFloat)
+				snprintf(str, sizeof(str), "%g", inItem->value.u.fvalue);
+			else if (inItem->value.type == kBoolean)
+				snprintf(str, sizeof(str), "%s", inItem->value.u.ivalue ? "True" : "False");
+			else
+				snprintf(str, sizeof(str), "%d", (int) inItem->value.u.ivalue);
+			AllocateValueString_(ip, str, &val);
+		}
+		break;
+	}
+
+	SetOutputPropertyValue_(ip, inActorInfo, inPropertyIndex1, &val);
+
+	if (val.type == kString)
+		ReleaseValueString_(ip, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputPythonResult
+// ---------------------------------------------------------------------------------
+// Sends the result of a succesful call to the outputs of the actor.
+
+static void
+OutputPythonResult(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	const PythonResult*	inResult)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	Value val;
+
+	// Show result
+	if (inResult->items != NULL)
+	{
+		// Fan the elements out to the value outputs, by position or by key
+		unsigned int i, j;
+		for (i=0; i<info->mNumValueOutputs; i++)
+		{
+			const PythonResult *item = NULL;
+			for (j=0; j<inResult->numItems && item == NULL; j++)
+			{
+				if (inResult->items[j].key == NULL ? (i == j) : (strcmp(inResult->items[j].key, info->mValueOutputs[i].name) == 0))
+					item = &inResult->items[j];
+			}
+			if (item != NULL)
+				OutputResultItem(ip, inActorInfo, kOutputValue + i, info->mValueOutputs[i].type, item);
+		}
+	}
+	else if (inResult->value.type == kString)
+	{
+		val.type = kString;
+		AllocateValueString_(ip, inResult->str, &val);
+		SetOutputPropertyValue_(ip, inActorInfo, kOutputResult, &val);
+		ReleaseValueString_(ip, &val);
+	}
+	else if (info->mNumValueOutputs == 1 && info->mValueOutputs[0].type == inResult->value.type)
+	{
+		val = inResult->value;
+		SetOutputPropertyValue_(ip, inActorInfo, kOutputValue, &val);
+	}
+
+	// Reset error output
+	val.type = kString;
+	AllocateValueString_(ip, "", &val);
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputError, &val);
+	ReleaseValueString_(ip, &val);
+
+	// Output trigger
+	val.type = kBoolean;
+	val.u.ivalue = 1;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputTrigger, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputPythonError
+// ---------------------------------------------------------------------------------
+// Sends the error of a failed call to the error output of the actor.
+
+static void
+OutputPythonError(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	const char*			inError)
+{
+	Value val;
+
+	val.type = kString;
+	AllocateValueString_(ip, inError, &val);
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputError, &val);
+	ReleaseValueString_(ip, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 UpdateArgTuple
+// ---------------------------------------------------------------------------------
+// Returns the argument tuple of the actor (a borrowed reference), updated with the
+// current argument values. Must be called with the GIL of the interpreter of the
+// actor held.
+
+static PyObject*
+UpdateArgTuple(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PyObject *pArgs;
+	unsigned int i;
+
+	// NB: PyObjects returned by PyObject_*, PyNumber_*, PySequence_* or PyMapping_* functions must
+	// be dererefereced using Py_DECREF, PyObjects returned by PyString_*, PyTuple_* etc must not!
+	// See https://docs.python.org/2/c-api/intro.html#reference-counts
+
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	UInt32 propCount, argCount;
+	GetPropertyCount_(ip, inActorInfo, kInputProperty, &propCount);
+
+	argCount = propCount - (kInputArg0-1);
+
+	// Reuse the arguments of the previous call, unless the function kept a reference
+	// to the tuple, or argument inputs were added or removed since
+	pArgs = info->mArgTuple;
+	if (pArgs != NULL && (Py_REFCNT(pArgs) != 1 || info->mArgTupleInputs != argCount))
+	{
+		Py_CLEAR(info->mArgTuple);
+		pArgs = NULL;
+	}
+	if (pArgs == NULL)
+	{
+		pArgs = PyTuple_New(info->mNumArgs);
+		info->mArgTuple = pArgs;
+		info->mArgTupleInputs = argCount;
+		for (i=0; i<info->mNumArgs; i++)
+			info->mArgs[i].dirty = true;
+	}
+
+	// Only convert the arguments that changed
+	for (i=0; i<info->mNumArgs; i++)
+	{
+		Property *arg = &info->mArgs[i];
+		if (!arg->dirty)
+			continue;
+		arg->dirty = false;
+
+		// PyTuple_SetItem steals a reference, and releases the previous value
+		if (i < argCount)
+		{
+			Value *val = GetInputPropertyValue_(ip, inActorInfo, kInputArg0 + i);
+			ValueConverter convert = (val->type == arg->value.type) ? arg->convert : ValueToPython;
+			PyTuple_SetItem(pArgs, i, convert(val, (val->type == kString) ? val->u.str->strData : NULL));
+		}
+		else
+		{
+			Py_INCREF(Py_None);
+			PyTuple_SetItem(pArgs, i, Py_None);
+		}
+	}
+
+	return pArgs;
+}
+
+// ---------------------------------------------------------------------------------
+//		 RunPythonFunc
+// ---------------------------------------------------------------------------------
+// Calls the function with the current argument values. Either the result or the
+// error string is returned, to be freed by the caller. Must be called with the GIL
+// of the interpreter of the actor held.
+
+static void
+RunPythonFunc(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	PythonResult*		outResult,
+	char**				outError)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	// The function was resolved by FindPythonFunc
+	PyObject *pFunc = info->mPyFunc;
+
+	double start = GetSeconds();
+
+	PyObject *pArgs = UpdateArgTuple(ip, inActorInfo);
+
+	// Make the call to the function
+	double python = 0;
+	double callStart = GetSeconds();
+	LockAsyncCall(info->mAsyncCall);
+	Deadline deadline;
+	StartDeadline(&deadline, info->mInterpreter, info->mTimeout, (info->mFuncKind == kFuncProcess) ? pFunc : NULL);
+	if (info->mMap && info->mNumArgs > 0)
+	{
+		// The list is the text of the first argument input
+		Value *val = (info->mArgTupleInputs > 0) ? GetInputPropertyValue_(ip, inActorInfo, kInputArg0) : NULL;
+		const char *list = (val != NULL && val->type == kString && val->u.str != NULL) ? val->u.str->strData : NULL;
+		*outError = MapPythonObject(pFunc, info->mFuncKind, &info->mAsyncCall->state, pArgs, info->mKwNames, list, info->mSeparator, info->mMapType, outResult, &python);
+	}
+	else
+	{
+		*outError = CallPythonObject(pFunc, info->mFuncKind, &info->mAsyncCall->state, pArgs, info->mKwNames, info->mResultKind, info->mResultType, outResult, &python);
+	}
+	if (EndDeadline(&deadline))
+		*outError = FormatTimeoutError(*outError, info->mTimeout);
+	UnlockAsyncCall(info->mAsyncCall);
+	double end = GetSeconds();
+
+	if (info->mTimeout > 0 && python > info->mTimeout)
+		info->mOverruns++;
+
+	if (info->mStatsOn)
+		info->mStats.python = python;
+
+	RecordTraceEvent("convert", inActorInfo, info->mFunc, start, callStart);
+	RecordTraceEvent("call", inActorInfo, info->mFunc, callStart, callStart + python / 1000);
+	RecordTraceEvent("result", inActorInfo, info->mFunc, callStart + python / 1000, end);
+}
+
+// ---------------------------------------------------------------------------------
+//		 CopyPythonResult
+// ---------------------------------------------------------------------------------
+// Copies a converted return value, including its string data and items.
+
+static void
+CopyPythonResult(
+	const PythonResult*	inResult,
+	PythonResult*		outResult)
+{
+	*outResult = *inResult;
+	if (inResult->str != NULL)
+	{
+		outResult->str = static_cast<char*>(malloc(strlen(inResult->str)+1));
+		strcpy(outResult->str, inResult->str);
+	}
+	if (inResult->key != NULL)
+	{
+		outResult->key = static_cast<char*>(malloc(strlen(inResult->key)+1));
+		strcpy(outResult->key, inResult->key);
+	}
+	if (inResult->items != NULL)
+	{
+		outResult->items = (PythonResult*) calloc(inResult->numItems > 0 ? inResult->numItems : 1, sizeof(PythonResult));
+		unsigned int i;
+		for (i=0; i<inResult->numItems; i++)
+			CopyPythonResult(&inResult->items[i], &outResult->items[i]);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 HashArgInputs
+// ---------------------------------------------------------------------------------
+// Returns a hash (32 bit FNV-1a) of the current argument values of the actor.
+
+static UInt32
+HashArgInputs(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	unsigned int		inNumArgs)
+{
+	UInt32 propCount, argCount;
+	GetPropertyCount_(ip, inActorInfo, kInputProperty, &propCount);
+
+	argCount = propCount - (kInputArg0-1);
+
+	UInt32 hash = 2166136261u;
+	unsigned int i;
+	for (i=0; i<inNumArgs && i<argCount; i++)
+	{
+		Value *val = GetInputPropertyValue_(ip, inActorInfo, kInputArg0 + i);
+		const unsigned char *data;
+		size_t size;
+		if (val->type == kString)
+		{
+			data = (const unsigned char*) val->u.str->strData;
+			size = strlen(val->u.str->strData);
+		}
+		else
+		{
+			data = (const unsigned char*) &val->u;
+			size = (val->type == kFloat) ? sizeof(val->u.fvalue) : sizeof(val->u.ivalue);
+		}
+
+		hash = (hash ^ (UInt32) val->type) * 16777619u;
+		while (size-- > 0)
+			hash = (hash ^ *data++) * 16777619u;
+	}
+	return (hash ^ i) * 16777619u;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ArgInputsEqual
+// ---------------------------------------------------------------------------------
+// Returns true if the current argument values of the actor are equal to a copy
+// made by CopyArgValues.
+
+static bool
+ArgInputsEqual(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	const ArgValue*		inArgs,
+	unsigned int		inNumArgs)
+{
+	UInt32 propCount, argCount;
+	GetPropertyCount_(ip, inActorInfo, kInputProperty, &propCount);
+
+	argCount = propCount - (kInputArg0-1);
+
+	unsigned int i;
+	for (i=0; i<inNumArgs; i++)
+	{
+		if (inArgs[i].present != (i < argCount))
+			return false;
+		if (!inArgs[i].present)
+			continue;
+
+		Value *val = GetInputPropertyValue_(ip, inActorInfo, kInputArg0 + i);
+		if (val->type != inArgs[i].value.type)
+			return false;
+		if (val->type == kString)
+		{
+			if (strcmp(val->u.str->strData, inArgs[i].str) != 0)
+				return false;
+		}
+		else if (val->type == kFloat)
+		{
+			if (val->u.fvalue != inArgs[i].value.u.fvalue)
+				return false;
+		}
+		else if (val->u.ivalue != inArgs[i].value.u.ivalue)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 FindCachedResult
+// ---------------------------------------------------------------------------------
+// Looks up the result for the current argument values in the result cache of the
+// actor, and copies it to outResult. Returns false if the cache is off, if the
+// function keeps state between calls, or if it was not called with these arguments
+// recently; outHash receives the hash to store the result under. Does not need the
+// GIL.
+
+static bool
+FindCachedResult(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	UInt32*				outHash,
+	PythonResult*		outResult)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	ResultCache* cache = &info->mCache;
+
+	if (cache->size == 0 || info->mStateful)
+		return false;
+
+	*outHash = HashArgInputs(ip, inActorInfo, info->mNumArgs);
+
+	CacheEntry *entry = (cache->buckets != NULL) ? cache->buckets[*outHash & (cache->numBuckets - 1)] : NULL;
+	while (entry != NULL && !(entry->hash == *outHash && entry->numArgs == info->mNumArgs
+								&& ArgInputsEqual(ip, inActorInfo, entry->args, entry->numArgs)))
+		entry = entry->nextInBucket;
+
+	if (entry == NULL)
+	{
+		cache->misses++;
+		return false;
+	}
+	cache->hits++;
+
+	// Move the entry to the front of the LRU list
+	if (entry != cache->newest)
+	{
+		entry->newer->older = entry->older;
+		if (entry->older != NULL)
+			entry->older->newer = entry->newer;
+		else
+			cache->oldest = entry->newer;
+		entry->newer = NULL;
+		entry->older = cache->newest;
+		cache->newest->newer = entry;
+		cache->newest = entry;
+	}
+
+	CopyPythonResult(&entry->result, outResult);
+	return true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 StoreCachedResult
+// ---------------------------------------------------------------------------------
+// Stores a copy of the result for the current argument values in the result cache
+// of the actor, evicting the least recently used entry when the cache is full.
+
+static void
+StoreCachedResult(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	UInt32				inHash,
+	const PythonResult*	inResult)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	ResultCache* cache = &info->mCache;
+
+	if (cache->size == 0 || info->mStateful)
+		return;
+
+	if (cache->buckets == NULL)
+	{
+		// a power of two, with at most two entries per bucket on average
+		cache->numBuckets = 1;
+		while (cache->numBuckets * 2 < cache->size)
+			cache->numBuckets *= 2;
+		cache->buckets = (CacheEntry**) calloc(cache->numBuckets, sizeof(CacheEntry*));
+	}
+
+	CacheEntry *entry;
+	if (cache->count < cache->size)
+	{
+		entry = (CacheEntry*) calloc(1, sizeof(CacheEntry));
+		cache->count++;
+	}
+	else
+	{
+		// Reuse the least recently used entry
+		entry = cache->oldest;
+		cache->oldest = entry->newer;
+		if (cache->oldest != NULL)
+			cache->oldest->older = NULL;
+		else
+			cache->newest = NULL;
+
+		CacheEntry **link = &cache->buckets[entry->hash & (cache->numBuckets - 1)];
+		while (*link != entry)
+			link = &(*link)->nextInBucket;
+		*link = entry->nextInBucket;
+
+		FreeArgValues(entry->args, entry->numArgs);
+		FreePythonResult(&entry->result);
+	}
+
+	entry->hash = inHash;
+	entry->args = CopyArgValues(ip, inActorInfo, info->mNumArgs);
+	entry->numArgs = info->mNumArgs;
+	CopyPythonResult(inResult, &entry->result);
+
+	entry->nextInBucket = cache->buckets[inHash & (cache->numBuckets - 1)];
+	cache->buckets[inHash & (cache->numBuckets - 1)] = entry;
+
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if (cache->newest != NULL)
+		cache->newest->newer = entry;
+	else
+		cache->oldest = entry;
+	cache->newest = entry;
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputCacheCounters
+// ---------------------------------------------------------------------------------
+// Sends the number of cache hits and misses to the outputs of the actor.
+
+static void
+OutputCacheCounters(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	Value val;
+
+	val.type = kInteger;
+	val.u.ivalue = (SInt32) info->mCache.hits;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputCacheHits, &val);
+
+	val.u.ivalue = (SInt32) info->mCache.misses;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputCacheMisses, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputOverruns
+// ---------------------------------------------------------------------------------
+// Sends the number of calls that took longer than the time limit to its output.
+
+static void
+OutputOverruns(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	Value val;
+
+	val.type = kInteger;
+	val.u.ivalue = (SInt32) info->mOverruns;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputOverruns, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 RecordCallStats
+// ---------------------------------------------------------------------------------
+// Adds a finished call to the statistics of an actor, and sends its timing to the
+// statistics outputs. The time waiting for the GIL and spent in python have been
+// recorded in mStats while the call was made.
+
+static void
+RecordCallStats(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	double				inDuration)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	CallStats *stats = &info->mStats;
+	
+	stats->average = (stats->average == 0) ? inDuration : stats->average * 0.9 + inDuration * 0.1;
+	if (inDuration > stats->max)
+		stats->max = inDuration;
+	stats->rateCalls++;
+	
+	double convert = inDuration - stats->gilWait - stats->python;
+	
+	Value val;
+	val.type = kFloat;
+	
+	val.u.fvalue = (float) inDuration;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputCallTime, &val);
+	
+	val.u.fvalue = (float) stats->average;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputAverageTime, &val);
+	
+	val.u.fvalue = (float) stats->max;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputMaxTime, &val);
+	
+	val.u.fvalue = (float) stats->gilWait;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputGILWait, &val);
+	
+	val.u.fvalue = (float) (convert > 0 ? convert : 0);
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputConvertTime, &val);
+}
+
+// ---------------------------------------------------------------------------------
+//		 OutputCallRate
+// ---------------------------------------------------------------------------------
+// Sends the number of calls per second to its output, about once per second.
+
+static void
+OutputCallRate(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	CallStats *stats = &info->mStats;
+	
+	double now = GetSeconds();
+	if (now - stats->rateStart < 1.0)
+		return;
+	
+	Value val;
+	val.type = kFloat;
+	val.u.fvalue = (float) (stats->rateCalls / (now - stats->rateStart));
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputCallRate, &val);
+	
+	stats->rateStart = now;
+	stats->rateCalls = 0;
+}
+
+// ---------------------------------------------------------------------------------
+//		 CallPythonFunc
+// ---------------------------------------------------------------------------------
+
+static void
+CallPythonFunc(
+	IsadoraParameters*	ip,
+	ActorInfo* inActorInfo )
+{
+	PythonResult result;
+	char *error = NULL;
+
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	if (info->mPyFunc == NULL)
+		return;
+
+	double start = GetSeconds();
+	info->mStats.gilWait = info->mStats.python = 0;
+
+	// Output a cached result without entering python at all
+	UInt32 hash = 0;
+	bool cached = FindCachedResult(ip, inActorInfo, &hash, &result);
+	if (!cached)
+	{
+		// Enter the python interpreter of the actor
+		double waitStart = GetSeconds();
+		PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+		double waitEnd = GetSeconds();
+		RecordTraceEvent("wait", inActorInfo, info->mFunc, waitStart, waitEnd);
+		if (info->mStatsOn)
+			info->mStats.gilWait = (waitEnd - waitStart) * 1000;
+
+		RunPythonFunc(ip, inActorInfo, &result, &error);
+
+		// Leave the python interpreter before passing the result on to other actors
+		LeavePythonInterpreter(info->mInterpreter, gstate);
+
+		if (error == NULL)
+			StoreCachedResult(ip, inActorInfo, hash, &result);
+	}
+
+	double outputStart = GetSeconds();
+
+	if (info->mCache.size > 0)
+		OutputCacheCounters(ip, inActorInfo);
+
+	if (info->mTimeout > 0)
+		OutputOverruns(ip, inActorInfo);
+
+	if (error == NULL)
+		OutputPythonResult(ip, inActorInfo, &result);
+	else
+		OutputPythonError(ip, inActorInfo, error);
+
+	FreePythonResult(&result);
+	free(error);
+
+	double end = GetSeconds();
+	RecordTraceEvent("output", inActorInfo, info->mFunc, outputStart, end);
+	if (info->mStatsOn)
+		RecordCallStats(ip, inActorInfo, (end - start) * 1000);
+}
+
+// ---------------------------------------------------------------------------------
+//		 PullStream
+// ---------------------------------------------------------------------------------
+// Outputs the next result of the stream of an actor. When the stream has no more
+// results, or raised an error, it is released and the exhausted output is triggered.
+
+static void
+PullStream(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	if (info->mStream == NULL)
+		return;
+
+	PythonResult result;
+	memset(&result, 0, sizeof(PythonResult));
+	result.value.type = info->mResultType;
+	char *error = NULL;
+	bool exhausted = false;
+
+	double start = GetSeconds();
+	PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+	LockAsyncCall(info->mAsyncCall);
+	double callStart = GetSeconds();
+	info->mStats.gilWait = (callStart - start) * 1000;
+
+	Deadline deadline;
+	StartDeadline(&deadline, info->mInterpreter, info->mTimeout, NULL);
+	PyObject *pValue = PyIter_Next(info->mStream);
+	bool timedOut = EndDeadline(&deadline);
+	double callEnd = GetSeconds();
+
+	if (pValue != NULL)
+	{
+		if (!PythonToResult(pValue, info->mResultKind, info->mResultType, &result))
+		{
+			FreePythonResult(&result);
+			error = FetchPythonError();
+		}
+		Py_DECREF(pValue);
+	}
+	else
+	{
+		exhausted = !PyErr_Occurred();
+		if (!exhausted)
+			error = FetchPythonError();
+		Py_CLEAR(info->mStream);
+	}
+	if (timedOut)
+		error = FormatTimeoutError(error, info->mTimeout);
+	PyErr_Clear();
+
+	UnlockAsyncCall(info->mAsyncCall);
+	LeavePythonInterpreter(info->mInterpreter, gstate);
+
+	info->mStats.python = (callEnd - callStart) * 1000;
+	if (info->mTimeout > 0 && info->mStats.python > info->mTimeout)
+		info->mOverruns++;
+
+	double outputStart = GetSeconds();
+	RecordTraceEvent("wait", inActorInfo, info->mFunc, start, callStart);
+	RecordTraceEvent("call", inActorInfo, info->mFunc, callStart, callEnd);
+	RecordTraceEvent("result", inActorInfo, info->mFunc, callEnd, outputStart);
+
+	if (info->mTimeout > 0)
+		OutputOverruns(ip, inActorInfo);
+
+	if (error != NULL)
+	{
+		OutputPythonError(ip, inActorInfo, error);
+	}
+	else if (!exhausted)
+	{
+		OutputPythonResult(ip, inActorInfo, &result);
+	}
+
+	if (info->mStream == NULL)
+	{
+		Value val;
+		val.type = kBoolean;
+		val.u.ivalue = 1;
+		SetOutputPropertyValue_(ip, inActorInfo, kOutputExhausted, &val);
+	}
+
+	FreePythonResult(&result);
+	free(error);
+
+	double end = GetSeconds();
+	RecordTraceEvent("output", inActorInfo, info->mFunc, outputStart, end);
+	if (info->mStatsOn)
+		RecordCallStats(ip, inActorInfo, (end - start) * 1000);
+}
+
+// ---------------------------------------------------------------------------------
+//		 StartStream
+// ---------------------------------------------------------------------------------
+// Calls the function with the current argument values, and keeps an iterator over
+// its return value as the stream of the actor, replacing a previous stream. A
+// generator function is started without taking its first value, and the elements
+// of other return values are iterated over. The first result is output right away.
+
+static void
+StartStream(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+
+	if (info->mPyFunc == NULL)
+		return;
+
+	char *error = NULL;
+
+	double start = GetSeconds();
+	PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+	PyObject *pArgs = UpdateArgTuple(ip, inActorInfo);
+	LockAsyncCall(info->mAsyncCall);
+	Py_CLEAR(info->mStream);
+
+	// The generator is created by calling the generator function like a plain function
+	FuncKind funcKind = (info->mFuncKind == kFuncGenerator) ? kFuncPlain : info->mFuncKind;
+	Deadline deadline;
+	StartDeadline(&deadline, info->mInterpreter, info->mTimeout, (funcKind == kFuncProcess) ? info->mPyFunc : NULL);
+	PyObject *pValue = InvokeFunction(info->mPyFunc, funcKind, &info->mAsyncCall->state, pArgs, info->mKwNames);
+	if (pValue != NULL)
+	{
+		info->mStream = PyObject_GetIter(pValue);
+		Py_DECREF(pValue);
+	}
+	bool timedOut = EndDeadline(&deadline);
+
+	if (info->mStream == NULL)
+	{
+		error = FetchPythonError();
+		if (timedOut)
+			error = FormatTimeoutError(error, info->mTimeout);
+	}
+	PyErr_Clear();
+
+	UnlockAsyncCall(info->mAsyncCall);
+	LeavePythonInterpreter(info->mInterpreter, gstate);
+
+	RecordTraceEvent("stream", inActorInfo, info->mFunc, start, GetSeconds());
+
+	if (error != NULL)
+	{
+		OutputPythonError(ip, inActorInfo, error);
+		free(error);
+		return;
+	}
+
+	PullStream(ip, inActorInfo);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ScheduleBatchedCall
+// ---------------------------------------------------------------------------------
+// Marks the actor to be called on the next video frame. Triggers arriving before
+// then are collapsed into a single call with the latest argument values.
+
+static void
+ScheduleBatchedCall(
+	ActorInfo*	inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	info->mBatchPending = true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 RunBatchedCalls
+// ---------------------------------------------------------------------------------
+// Calls the functions of all actors that were triggered since the last video frame.
+// The GIL of each interpreter is acquired once for all its actors, and the actors
+// are called in the order in which they were created. The results are output after
+// all calls are done and the GIL has been released again; triggers caused by these
+// outputs are handled on the next frame.
+
+static void
+RunBatchedCalls(
+	IsadoraParameters*	ip)
+{
+	unsigned int i;
+	PythonInterpreter *interp;
+
+	for (interp = sInterpreters; interp != NULL; interp = interp->next)
+	{
+		bool entered = false;
+		PyGILState_STATE gstate = PyGILState_UNLOCKED;
+
+		for (i=0; i<sNumActors; i++)
+		{
+			PluginInfo* info = GetPluginInfo_(sActors[i]);
+			if (!info->mBatchPending || info->mInterpreter != interp)
+				continue;
+
+			info->mBatchPending = false;
+			if (info->mPyFunc == NULL)
+				continue;
+
+			info->mBatchDone = true;
+
+			double start = GetSeconds();
+			info->mStats.gilWait = info->mStats.python = 0;
+
+			UInt32 hash = 0;
+			if (!FindCachedResult(ip, sActors[i], &hash, &info->mBatchResult))
+			{
+				// The first actor of the interpreter waits for the GIL for all of them
+				if (!entered)
+				{
+					gstate = EnterPythonInterpreter(interp);
+					entered = true;
+					double waitEnd = GetSeconds();
+					RecordTraceEvent("wait", sActors[i], info->mFunc, start, waitEnd);
+					if (info->mStatsOn)
+						info->mStats.gilWait = (waitEnd - start) * 1000;
+				}
+				RunPythonFunc(ip, sActors[i], &info->mBatchResult, &info->mBatchError);
+
+				if (info->mBatchError == NULL)
+					StoreCachedResult(ip, sActors[i], hash, &info->mBatchResult);
+			}
+
+			info->mStats.busy = (GetSeconds() - start) * 1000;
+		}
+
+		if (entered)
+			LeavePythonInterpreter(interp, gstate);
+	}
+
+	for (i=0; i<sNumActors; i++)
+	{
+		PluginInfo* info = GetPluginInfo_(sActors[i]);
+		if (!info->mBatchDone)
+			continue;
+
+		double start = GetSeconds();
+
+		PythonResult result = info->mBatchResult;
+		char *error = info->mBatchError;
+		memset(&info->mBatchResult, 0, sizeof(PythonResult));
+		info->mBatchError = NULL;
+		info->mBatchDone = false;
+
+		if (info->mCache.size > 0)
+			OutputCacheCounters(ip, sActors[i]);
+
+		if (info->mTimeout > 0)
+			OutputOverruns(ip, sActors[i]);
+
+		if (error == NULL)
+			OutputPythonResult(ip, sActors[i], &result);
+		else
+			OutputPythonError(ip, sActors[i], error);
+
+		FreePythonResult(&result);
+		free(error);
+
+		double end = GetSeconds();
+		RecordTraceEvent("output", sActors[i], info->mFunc, start, end);
+		if (info->mStatsOn)
+			RecordCallStats(ip, sActors[i], info->mStats.busy + (end - start) * 1000);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReceiveSchedulerMessage
+// ---------------------------------------------------------------------------------
+// Receives the video frame clock for all actors, while any actor is active.
+
+static void
+ReceiveSchedulerMessage(
+	IsadoraParameters*	ip,
+	MessageMask			/* inMessageMask */,
+	PluginMessageInfo*	/* inMessageInfo */,
+	MessageRefCon		/* inRefCon */)
+{
+	RunBatchedCalls(ip);
+}
+
+// ---------------------------------------------------------------------------------
+//		 FreeArgValues
+// ---------------------------------------------------------------------------------
+// Frees an array of argument copies created by CopyArgValues.
+
+static void
+FreeArgValues(
+	ArgValue*		args,
+	unsigned int	numArgs)
+{
+	if (args == NULL)
+		return;
+
+	unsigned int i;
+	for (i=0; i<numArgs; i++)
+	{
+		free(args[i].str);
+	}
+	free(args);
+}
+
+// ---------------------------------------------------------------------------------
+//		 CopyArgValues
+// ---------------------------------------------------------------------------------
+// Copies the current values of the argument inputs of the actor.
+
+static ArgValue*
+CopyArgValues(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	unsigned int		inNumArgs)
+{
+	ArgValue *args = (ArgValue*) calloc(inNumArgs > 0 ? inNumArgs : 1, sizeof(ArgValue));
+
+	UInt32 propCount, argCount;
+	GetPropertyCount_(ip, inActorInfo, kInputProperty, &propCount);
+
+	argCount = propCount - (kInputArg0-1);
+
+	unsigned int i;
+	for (i=0; i<inNumArgs && i<argCount; i++)
+	{
+		Value *val = GetInputPropertyValue_(ip, inActorInfo, kInputArg0 + i);
+		args[i].value = *val;
+		args[i].present = true;
+		if (val->type == kString)
+		{
+			args[i].value.u.str = NULL;
+			args[i].str = static_cast<char*>(malloc(strlen(val->u.str->strData)+1));
+			strcpy(args[i].str, val->u.str->strData);
+		}
+	}
+
+	return args;
+}
+
+// ---------------------------------------------------------------------------------
+//		 NewAsyncCall
+// ---------------------------------------------------------------------------------
+// Allocates the AsyncCall struct of an actor, with a reference for the actor.
+
+static AsyncCall*
+NewAsyncCall()
+{
+	AsyncCall *call = (AsyncCall*) calloc(1, sizeof(AsyncCall));
+	call->refCount = 1;
+	call->dataLock = PyThread_allocate_lock();
+	call->callLock = PyThread_allocate_lock();
+	return call;
+}
+
+// ---------------------------------------------------------------------------------
+//		 LockAsyncCall
+// ---------------------------------------------------------------------------------
+// Acquires the callLock of an AsyncCall. Must be called with the GIL held; while
+// another thread holds the lock, the GIL is released so that thread can finish.
+
+static void
+LockAsyncCall(
+	AsyncCall*	call)
+{
+	if (PyThread_acquire_lock(call->callLock, NOWAIT_LOCK))
+		return;
+
+	Py_BEGIN_ALLOW_THREADS
+	PyThread_acquire_lock(call->callLock, WAIT_LOCK);
+	Py_END_ALLOW_THREADS
+}
+
+// ---------------------------------------------------------------------------------
+//		 UnlockAsyncCall
+// ---------------------------------------------------------------------------------
+
+static void
+UnlockAsyncCall(
+	AsyncCall*	call)
+{
+	PyThread_release_lock(call->callLock);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReleaseAsyncCall
+// ---------------------------------------------------------------------------------
+// Removes a reference to an AsyncCall, freeing it when the last reference is removed.
+// Must be called with the GIL held, but without holding its dataLock.
+
+static void
+ReleaseAsyncCall(
+	AsyncCall* call )
+{
+	PyThread_acquire_lock(call->dataLock, WAIT_LOCK);
+	bool last = (--call->refCount == 0);
+	PyThread_release_lock(call->dataLock);
+
+	if (!last)
+		return;
+
+	Py_XDECREF(call->func);
+	Py_XDECREF(call->kwNames);
+	Py_XDECREF(call->state);
+	FreeArgValues(call->args, call->numArgs);
+	FreePythonResult(&call->result);
+	free(call->error);
+	PyThread_free_lock(call->dataLock);
+	PyThread_free_lock(call->callLock);
+	free(call);
+}
+
+// ---------------------------------------------------------------------------------
+//		 SignalAsyncWorker
+// ---------------------------------------------------------------------------------
+// Wakes up one of the worker threads of an interpreter. Must be called while holding
+// its queueLock.
+
+static void
+SignalAsyncWorker(
+	PythonInterpreter*	interp)
+{
+	if (!interp->workerSignaled)
+	{
+		interp->workerSignaled = true;
+		PyThread_release_lock(interp->workerSignal);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 RunNextAsyncCall
+// ---------------------------------------------------------------------------------
+// Takes the next call from the queue of an interpreter and executes it on one of its
+// worker threads. Calls of actors that are already running on another worker are
+// left in the queue. Returns false if there was no call to take. If inDiscard is
+// true, the call is removed from the queue without being executed.
+
+static bool
+RunNextAsyncCall(
+	PythonInterpreter*	interp,
+	PyThreadState*		inThreadState,
+	bool				inDiscard)
+{
+	PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+
+	AsyncCall **link = &interp->queueHead, *prev = NULL;
+	while (*link != NULL && (*link)->running)
+	{
+		prev = *link;
+		link = &prev->next;
+	}
+	AsyncCall *call = *link;
+	if (call == NULL)
+	{
+		PyThread_release_lock(interp->queueLock);
+		return false;
+	}
+
+	*link = call->next;
+	if (interp->queueTail == call)
+		interp->queueTail = prev;
+	call->next = NULL;
+	call->queued = false;
+	call->running = true;
+
+	// let another worker take the next call
+	if (!inDiscard && interp->queueHead != NULL)
+		SignalAsyncWorker(interp);
+
+	PyThread_release_lock(interp->queueLock);
+
+	// take the arguments; triggers arriving from now on queue the call again
+	PyThread_acquire_lock(call->dataLock, WAIT_LOCK);
+	ArgValue *args = call->args;
+	unsigned int numArgs = call->numArgs;
+	bool execute = !inDiscard && !call->disposed && call->pending;
+	call->args = NULL;
+	call->numArgs = 0;
+	call->pending = false;
+	ResultKind resultKind = call->resultKind;
+	ValueType resultType = call->resultType;
+	SInt32 timeout = call->timeout;
+	bool map = call->map;
+	ValueType mapType = call->mapType;
+	char separator[sizeof(call->separator)];
+	memcpy(separator, call->separator, sizeof(separator));
+	const void *actor = call->actor;
+	char funcName[sizeof(call->funcName)];
+	memcpy(funcName, call->funcName, sizeof(funcName));
+
+	PyThread_release_lock(call->dataLock);
+
+	double start = GetSeconds();
+	PyEval_RestoreThread(inThreadState);
+	double waitEnd = GetSeconds();
+	double gilWait = (waitEnd - start) * 1000;
+	double python = 0;
+
+	PythonResult result;
+	char *error = NULL;
+	memset(&result, 0, sizeof(PythonResult));
+	LockAsyncCall(call);
+	if (execute && call->func != NULL)
+	{
+		PyObject *pArgs = PyTuple_New(numArgs);
+		unsigned int i;
+		for (i=0; i<numArgs; i++)
+		{
+			PyObject *pArg;
+			if (args[i].present)
+			{
+				pArg = ValueToPython(&args[i].value, args[i].str);
+			}
+			else
+			{
+				Py_INCREF(Py_None);
+				pArg = Py_None;
+			}
+			PyTuple_SetItem(pArgs, i, pArg);
+		}
+
+		double callStart = GetSeconds();
+		Deadline deadline;
+		StartDeadline(&deadline, interp, timeout, (call->funcKind == kFuncProcess) ? call->func : NULL);
+		if (map && numArgs > 0)
+			error = MapPythonObject(call->func, call->funcKind, &call->state, pArgs, call->kwNames, args[0].str, separator, mapType, &result, &python);
+		else
+			error = CallPythonObject(call->func, call->funcKind, &call->state, pArgs, call->kwNames, resultKind, resultType, &result, &python);
+		if (EndDeadline(&deadline))
+			error = FormatTimeoutError(error, timeout);
+		Py_DECREF(pArgs);
+
+		RecordTraceEvent("wait", actor, funcName, start, waitEnd);
+		RecordTraceEvent("convert", actor, funcName, waitEnd, callStart);
+		RecordTraceEvent("call", actor, funcName, callStart, callStart + python / 1000);
+		RecordTraceEvent("result", actor, funcName, callStart + python / 1000, GetSeconds());
+	}
+	UnlockAsyncCall(call);
+	FreeArgValues(args, numArgs);
+
+	// let a worker run the call again, if it was queued meanwhile
+	PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+	call->running = false;
+	PyThread_release_lock(interp->queueLock);
+
+	// hand the result to the actor; an undelivered older result is replaced
+	PyThread_acquire_lock(call->dataLock, WAIT_LOCK);
+	if (execute)
+	{
+		if (!call->disposed)
+		{
+			FreePythonResult(&call->result);
+			free(call->error);
+			call->result = result;
+			call->error = error;
+			call->hasResult = true;
+			call->gilWait = gilWait;
+			call->python = python;
+			call->busy = (GetSeconds() - start) * 1000;
+			if (timeout > 0 && python > timeout)
+				call->overruns++;
+			memset(&result, 0, sizeof(PythonResult));
+			error = NULL;
+		}
 	}
-	else if (inIndex >= 100 && inIndex < 100 + kTwoCharMax)
-	{	
-		indexOffset = inIndex - 100;
-		PluginAssert_(ip, indexOffset >= 0 && indexOffset < kTwoCharMax);
-		indexMS = indexOffset / kOneCharMax;
-		indexLS = indexOffset % kOneCharMax;
-		
-		result |= ( (((UInt32) (indexMS + 'A')) << 8) | (((UInt32) (indexLS + 'A')) << 0) );
-		
-		// if between 776 and 1452
+	PyThread_release_lock(call->dataLock);
+	FreePythonResult(&result);
+	free(error);
+
+	ReleaseAsyncCall(call);
+
+	PyEval_SaveThread();
+
+	return true;
+}
+
+// ---------------------------------------------------------------------------------
+//		 AsyncWorker
+// ---------------------------------------------------------------------------------
+// A worker thread of an interpreter. Executes queued calls until the workers are
+// stopped. The last worker to exit releases workerDone.
+
+static void
+AsyncWorker(
+	void*	inParam)
+{
+	PythonInterpreter* interp = (PythonInterpreter*) inParam;
+
+	// Create a thread state for this thread, and keep it while the thread runs
+	PyGILState_STATE gstate = PyGILState_UNLOCKED;
+	PyThreadState *threadState;
+	if (interp->threadState == NULL)
+	{
+		gstate = PyGILState_Ensure();
+		threadState = PyEval_SaveThread();
 	}
-	else if (inIndex >= 100 + kTwoCharMax && inIndex < 100 + kTwoCharMax * 2)
-	{	
-		indexOffset = inIndex - (100 + kTwoCharMax);
-		PluginAssert_(ip, indexOffset >= 0 && indexOffset < kTwoCharMax);
-		indexMS = indexOffset / kOneCharMax;
-		indexLS = indexOffset % kOneCharMax;
-		
-		result |= ( (((UInt32) (indexMS + 'a')) << 8) | (((UInt32) (indexLS + 'a')) << 0) );
-		
+	else
+	{
+		threadState = PyThreadState_New(interp->state);
+	}
+
+	bool stop = false;
+	while (!stop)
+	{
+		// Wait until calls are queued
+		PyThread_acquire_lock(interp->workerSignal, WAIT_LOCK);
+
+		PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+		interp->workerSignaled = false;
+		stop = interp->workerStop;
+		PyThread_release_lock(interp->queueLock);
+
+		while (RunNextAsyncCall(interp, threadState, stop))
+			;
+	}
+
+	PyEval_RestoreThread(threadState);
+	if (interp->threadState == NULL)
+	{
+		PyGILState_Release(gstate);
 	}
 	else
 	{
-		PluginAssert_(ip, false);
+		PyThreadState_Clear(threadState);
+		PyThreadState_DeleteCurrent();
 	}
-	
-	return result;
+
+	// wake up the next worker to stop
+	PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+	bool last = (--interp->numWorkers == 0);
+	if (!last)
+		SignalAsyncWorker(interp);
+	PyThread_release_lock(interp->queueLock);
+
+	if (last)
+		PyThread_release_lock(interp->workerDone);
 }
 
 // ---------------------------------------------------------------------------------
-//		 FindPythonFunc
+//		 StopAsyncWorker
 // ---------------------------------------------------------------------------------
+// Stops the worker threads of an interpreter, discarding any queued calls, and waits
+// for them to exit. Must be called without holding the GIL.
 
 static void
-FindPythonFunc(
+StopAsyncWorker(
+	PythonInterpreter*	interp)
+{
+	if (interp->numWorkers == 0)
+		return;
+
+	PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+	interp->workerStop = true;
+	SignalAsyncWorker(interp);
+	PyThread_release_lock(interp->queueLock);
+
+	PyThread_acquire_lock(interp->workerDone, WAIT_LOCK);
+
+	interp->workerStop = false;
+}
+
+// ---------------------------------------------------------------------------------
+//		 QueueAsyncCall
+// ---------------------------------------------------------------------------------
+// Queues a call of the function with the current argument values, to be executed
+// on a worker thread of the interpreter of the actor. Does not need the GIL.
+
+static void
+QueueAsyncCall(
 	IsadoraParameters*	ip,
-	PluginInfo* info )
-{	
-	PyObject *pName, *pModule, *pDict, *pFunc = NULL, *pInspect, *argspec_tuple, *arglist, *defaults, *defaultvalue;
-	int size = 0, i;
-	
-	// NB: PyObjects returned by PyObject_*, PyNumber_*, PySequence_* or PyMapping_* functions must 
-	// be dererefereced using Py_DECREF, PyObjects returned by PyString_*, PyTuple_* etc must not!
-	// See https://docs.python.org/2/c-api/intro.html#reference-counts
-	
-	if (info->mArgs != NULL)
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	AsyncCall* call = info->mAsyncCall;
+	PythonInterpreter* interp = info->mInterpreter;
+
+	if (interp->numWorkers == 0)
 	{
-		// free memory for previously created args
-		size = info->mNumArgs;
-		for (i=0; i<size; i++)
+		unsigned int i;
+		for (i=0; i<sNumAsyncWorkers; i++)
 		{
-			free(info->mArgs[i]->name);
-			if (info->mArgs[i]->value->type == kString)
+			interp->numWorkers++;
+			if ((long)PyThread_start_new_thread(AsyncWorker, interp) == -1)
 			{
-				ReleaseValueString_(ip, info->mArgs[i]->value);
+				interp->numWorkers--;
+				break;
 			}
-			free(info->mArgs[i]->value);
-			free(info->mArgs[i]);
 		}
-		free(info->mArgs);
-		info->mArgs = NULL;
-		size = 0;
+		if (interp->numWorkers == 0)
+		{
+			OutputPythonError(ip, inActorInfo, "could not start the worker thread");
+			return;
+		}
 	}
 
-	info->mFuncFound = false;
-	info->mNumArgs = 0;
+	ArgValue *args = CopyArgValues(ip, inActorInfo, info->mNumArgs);
 
-	if (info->mFile == NULL || strlen(info->mFile) == 0 || info->mFunc == NULL || strlen(info->mFunc) == 0)
-		return;
+	PyThread_acquire_lock(call->dataLock, WAIT_LOCK);
 
-	// Initialize the python interpreter
-	Py_Initialize();
-	
-	// Make sure we are getting the module from the correct place
-	if (info->mPath != NULL && strlen(info->mPath) > 0)
-	{
-		char *buffer = (char*)malloc( strlen(info->mPath)+25 );
-		sprintf(buffer, "sys.path.append(\"%s\")", info->mPath);
+	// latest wins: replace the arguments of a call that is still waiting
+	ArgValue *oldArgs = call->args;
+	unsigned int oldNumArgs = call->numArgs;
+	call->args = args;
+	call->numArgs = info->mNumArgs;
+	call->pending = true;
+	call->resultKind = info->mResultKind;
+	call->resultType = info->mResultType;
+	call->timeout = info->mTimeout;
+	call->map = info->mMap;
+	call->mapType = info->mMapType;
+	memcpy(call->separator, info->mSeparator, sizeof(call->separator));
+	call->actor = inActorInfo;
+	snprintf(call->funcName, sizeof(call->funcName), "%s", (info->mFunc != NULL) ? info->mFunc : "");
 
-		PyRun_SimpleString("import sys");
-		PyRun_SimpleString(buffer);
-		free(buffer);
-	}
-	
-	// Build the name object
-	pName = PyString_FromString(info->mFile);
-	if (pName != NULL)
-	{	
-		// Load the module object
-		pModule = PyImport_Import(pName);
-		if (pModule != NULL)
-		{
-			pDict = PyModule_GetDict(pModule);
-			if (pDict != NULL)
-			{
-				pFunc = PyDict_GetItemString(pDict, info->mFunc);
-			}
-		}
-	}
-	
-	info->mFuncFound = (pFunc != NULL && PyCallable_Check(pFunc));
-	
-	pName = PyString_FromString("inspect");	
-	if (pName != NULL)
+	PyThread_acquire_lock(interp->queueLock, WAIT_LOCK);
+	if (!call->queued)
 	{
-		pInspect = PyImport_Import(pName);
-		if (pInspect != NULL)
-		{
-			pName = PyString_FromString("getargspec");
-			if (pName != NULL)
-			{
-				argspec_tuple = PyObject_CallMethodObjArgs(pInspect, pName, pFunc, NULL);
-				if (argspec_tuple != NULL)
-				{
-					arglist = PyTuple_GetItem(argspec_tuple, 0);
-					defaults = PyTuple_GetItem(argspec_tuple, 3);
-					if (arglist != NULL && defaults != NULL)
-					{
-						// get the number arguments
-						size = (int)PyObject_Size(arglist);
-						
-						int defaults_offset = (int)PyObject_Size(defaults) - size;
-						
-						//allocate memory for properties
-						info->mArgs = (Property**)malloc(size * sizeof(Property));
-						
-						for (i=0; i<size; i++)
-						{
-							//grab the list of parameters
-							PyObject *list = PyList_GetItem(arglist,i);
-							
-							//grab python strings from the list
-							PyObject *argname = PyObject_Str(list);
-							
-							//convert python string to C string
-							char *name = PyString_AsString(argname);
-							info->mArgs[i] = (Property*)malloc(sizeof(Property));
-							info->mArgs[i]->name = static_cast<char*>(malloc(strlen(name)+1));
-							strcpy(info->mArgs[i]->name, name);
-							
-							info->mArgs[i]->value = (Value*)malloc(sizeof(Value));
-							
-							//try to deduce the argument type
-							
-							if (i + defaults_offset >= 0) {
-								//first check if there is a default value we can use
-								defaultvalue = PyTuple_GetItem(defaults, i+defaults_offset);
-								const char* type = defaultvalue->ob_type->tp_name;
-								
-								if (strcmp(type, "int") == 0)
-								{
-									info->mArgs[i]->value->type = kInteger;
-									info->mArgs[i]->value->u.ivalue = PyInt_AsLong(defaultvalue);
-								}
-								else if (strcmp(type, "float") == 0)
-								{
-									info->mArgs[i]->value->type = kFloat;
-									info->mArgs[i]->value->u.fvalue = (float)PyFloat_AsDouble(defaultvalue);
-								}
-								else if (strcmp(type, "bool") == 0)
-								{
-									info->mArgs[i]->value->type = kBoolean;
-									info->mArgs[i]->value->u.ivalue = PyInt_AsLong(defaultvalue);
-								}
-								else // anything from str to tuple, dict, none
-								{
-									info->mArgs[i]->value->type = kString;
-									PyObject *pStr = PyObject_Str(defaultvalue);
-									char *str = PyString_AsString(pStr);
-									AllocateValueString_(ip, str, info->mArgs[i]->value);
-									Py_DECREF(pStr);
-								}
-							}
-							else
-							{
-								// get the types by chopping after the underscore
-								char *temp = PyString_AsString(argname);
-								char *delims = "_";
-								char *result;
-								result = strtok( temp, delims );
-								
-								while (result != NULL)
-								{
-									result = strtok( NULL, delims );
-									if (result == NULL)
-										break;
-									else
-									{
-										if (strcmp(result,"int") == 0)
-										{
-											info->mArgs[i]->value->type = kInteger;
-											info->mArgs[i]->value->u.ivalue = 0;
-										}
-										else if (strcmp(result,"float") == 0)
-										{
-											info->mArgs[i]->value->type = kFloat;
-											info->mArgs[i]->value->u.fvalue = 0;
-										}
-										else if (strcmp(result,"bool") == 0)
-										{
-											info->mArgs[i]->value->type = kBoolean;
-											info->mArgs[i]->value->u.ivalue = 0;
-										}
-										else
-										{
-											info->mArgs[i]->value->type = kString;
-											char *str = "";
-											AllocateValueString_(ip, str, info->mArgs[i]->value);
-										}
-									}
-								}
-							}
-							Py_DECREF(argname);
-						}
-					}
-					Py_DECREF(argspec_tuple);
-				}
-			}			
-		}
+		call->queued = true;
+		call->refCount++;
+		if (interp->queueTail != NULL)
+			interp->queueTail->next = call;
+		else
+			interp->queueHead = call;
+		interp->queueTail = call;
 	}
-	info->mNumArgs = size;
+	SignalAsyncWorker(interp);
+	PyThread_release_lock(interp->queueLock);
 
-	// Finish the Python Interpreter
-	Py_Finalize();
-	
-	return;
+	PyThread_release_lock(call->dataLock);
+
+	FreeArgValues(oldArgs, oldNumArgs);
 }
 
 // ---------------------------------------------------------------------------------
-//		 CallPythonFunc
+//		 DeliverAsyncResult
 // ---------------------------------------------------------------------------------
+// Sends the result of the last finished asynchronous call to the outputs of the
+// actor. Called from the video frame clock, on the main thread.
 
 static void
-CallPythonFunc(
+DeliverAsyncResult(
 	IsadoraParameters*	ip,
-	ActorInfo* inActorInfo )
+	ActorInfo*			inActorInfo)
 {
-	PyObject *pName, *pModule, *pDict, *pFunc = NULL, *pValue, *pArgs;
-	Value val;
-	unsigned int i, size = 0;
-	
-	// NB: PyObjects returned by PyObject_*, PyNumber_*, PySequence_* or PyMapping_* functions must 
-	// be dererefereced using Py_DECREF, PyObjects returned by PyString_*, PyTuple_* etc must not!
-	// See https://docs.python.org/2/c-api/intro.html#reference-counts
-	
 	PluginInfo* info = GetPluginInfo_(inActorInfo);
+	AsyncCall* call = info->mAsyncCall;
 
-	// Initialize the python interpreter
-	Py_Initialize();
-	
-	// Make sure we are getting the module from the correct place
-	if (info->mPath != NULL && strlen(info->mPath) > 0)
-	{
-		char *buffer = (char*)malloc( strlen(info->mPath)+25 );
-		sprintf(buffer, "sys.path.append(\"%s\")", info->mPath);
-
-		PyRun_SimpleString("import sys");
-		PyRun_SimpleString(buffer);
-		free(buffer);
-	}
-	
-	// Build the name object
-	pName = PyString_FromString(info->mFile);
-	if (pName != NULL)
+	PyThread_acquire_lock(call->dataLock, WAIT_LOCK);
+	if (!call->hasResult)
 	{
-		// Load the module object
-		pModule = PyImport_Import(pName);
-		if (pModule != NULL)
-		{
-			pDict = PyModule_GetDict(pModule);
-			if (pDict != NULL)
-			{
-				pFunc = PyDict_GetItemString(pDict, info->mFunc);
-			}
-		}
+		PyThread_release_lock(call->dataLock);
+		return;
 	}
+	PythonResult result = call->result;
+	char *error = call->error;
+	memset(&call->result, 0, sizeof(PythonResult));
+	call->error = NULL;
+	call->hasResult = false;
+	info->mStats.gilWait = call->gilWait;
+	info->mStats.python = call->python;
+	info->mStats.busy = call->busy;
+	info->mOverruns += call->overruns;
+	call->overruns = 0;
+	PyThread_release_lock(call->dataLock);
+
+	double start = GetSeconds();
+
+	if (info->mTimeout > 0)
+		OutputOverruns(ip, inActorInfo);
+
+	if (error == NULL)
+		OutputPythonResult(ip, inActorInfo, &result);
+	else
+		OutputPythonError(ip, inActorInfo, error);
+
+	FreePythonResult(&result);
+	free(error);
+
+	double end = GetSeconds();
+	RecordTraceEvent("output", inActorInfo, info->mFunc, start, end);
+	if (info->mStatsOn)
+		RecordCallStats(ip, inActorInfo, info->mStats.busy + (end - start) * 1000);
+}
+
+// ---------------------------------------------------------------------------------
+//		 DiscoverPythonFunc
+// ---------------------------------------------------------------------------------
+// Looks up the function for the current path, module and function inputs, and
+// outputs whether it was found.
+
+static void
+DiscoverPythonFunc(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo)
+{
+	PluginInfo* info = GetPluginInfo_(inActorInfo);
 	
-	if (PyCallable_Check(pFunc))
-	{		
-		// Set the number of arguments
-		pArgs = PyTuple_New(info->mNumArgs);
-		
-		UInt32 propCount, argCount;
-		IzzyError err = GetPropertyCount_(ip, inActorInfo, kInputProperty, &propCount);
-	
-		argCount = propCount - (kInputArg0-1);
+	info->mDiscoveryTicks = 0;
 	
-		for (i=0; i<info->mNumArgs; i++)
-		{
-			if (i < argCount) {
-				Value *val = GetInputPropertyValue_(ip, inActorInfo, kInputArg0 + i);
-				switch(val->type)
-				{
-				case kInteger:
-					PyTuple_SetItem(pArgs, i, PyInt_FromLong(val->u.ivalue));
-					break;
-				case kFloat:
-					PyTuple_SetItem(pArgs, i, PyFloat_FromDouble(val->u.fvalue));
-					break;
-				case kBoolean:
-					PyTuple_SetItem(pArgs, i, PyBool_FromLong(val->u.ivalue));
-					break;
-				case kString:
-					PyTuple_SetItem(pArgs, i, PyString_FromString(val->u.str->strData));
-					break;
-				}
-			}
-			else
-			{
-				PyTuple_SetItem(pArgs, i, Py_None);
-			}
-		}
-		// Make the call to the function
-		pValue = PyObject_CallObject(pFunc, pArgs);
-		
-		// Check for a return value and if its a tuple
-		if (pValue != NULL)
-		{
-			// Show result
-			val.type = kString;
-			PyObject *pStr = PyObject_Str(pValue);
-			AllocateValueString_(ip, PyString_AsString(pStr), &val);
-			SetOutputPropertyValue_(ip, inActorInfo, kOutputResult, &val);
-			ReleaseValueString_(ip, &val);
-			Py_DECREF(pStr);
-			
-			// Reset error output
-			val.type = kString;
-			AllocateValueString_(ip, "", &val);
-			SetOutputPropertyValue_(ip, inActorInfo, kOutputError, &val);
-			ReleaseValueString_(ip, &val);
-			
-			// Output trigger
-			val.type = kBoolean;
-			val.u.ivalue = 1;
-			SetOutputPropertyValue_(ip, inActorInfo, kOutputTrigger, &val);
-			
-			Py_DECREF(pValue);
-		}
-		else
-		{
-			PyObject *pErrType, *pErrValue, *pTraceback;
-			//pErrValue contains error message
-			//pTraceback contains stack snapshot and many other information
-			//(see python traceback structure)
-			
-			PyErr_Fetch(&pErrType, &pErrValue, &pTraceback);
+	ClearWatchedFiles(info);
+	FindPythonFunc(ip, info);
 			
-			val.type = kString;
-			if (pErrValue != NULL)
-				AllocateValueString_(ip, PyString_AsString(pErrValue), &val);
-			else
-				AllocateValueString_(ip, "unspecified error", &val);
-			SetOutputPropertyValue_(ip, inActorInfo, kOutputError, &val);
-			ReleaseValueString_(ip, &val);
-		}	
-	}
-	
-	// Finish the Python Interpreter
-	Py_Finalize();
+	// Output a boolean showing if the function was found
+	Value fv;
+	fv.type = kBoolean;
+	fv.u.ivalue = info->mFuncFound;
+	SetOutputPropertyValue_(ip, inActorInfo, kOutputFuncFound, &fv);
 }
-	
+
 // ---------------------------------------------------------------------------------
 //		 HandlePropertyChangeValue	[INTERRUPT SAFE]
 // ---------------------------------------------------------------------------------
@@ -872,20 +5943,29 @@ HandlePropertyChangeValue(
 	PropertyIndex		inPropertyIndex1,			// the one-based index of the property than changed values
 	ValuePtr			/* inOldValue */,			// the property's old value
 	ValuePtr			inNewValue,					// the property's new value
-	Boolean				/* inInitializing */)		// true if the value is being set when an actor is first initalized
+	Boolean				inInitializing)				// true if the value is being set when an actor is first initalized
 {
 	PluginInfo* info = GetPluginInfo_(inActorInfo);
 
 	bool findFunc = false;
 	
-	Value outputValue;
-	outputValue.type = kFloat;
-	
 	switch (inPropertyIndex1) {
 		
 		case kInputTrigger:
+			if (info->mDiscoveryTicks > 0)
+				DiscoverPythonFunc(ip, inActorInfo);
+			
 			if (info->mFuncFound)
-				CallPythonFunc(ip, inActorInfo);
+			{
+				if (info->mStreamMode != 0)
+					StartStream(ip, inActorInfo);
+				else if (info->mAsync)
+					QueueAsyncCall(ip, inActorInfo);
+				else if (info->mBatch)
+					ScheduleBatchedCall(inActorInfo);
+				else
+					CallPythonFunc(ip, inActorInfo);
+			}
 			break;
 		
 		case kInputPath:
@@ -930,28 +6010,202 @@ HandlePropertyChangeValue(
 			findFunc = true;
 			break;
 			
+		case kInputCode:
+			if (info->mCode != NULL)
+			{
+				free(info->mCode);
+				info->mCode = NULL;
+			}
+			if (info->mCode == NULL && inNewValue->u.str != NULL)
+			{
+				info->mCode = static_cast<char*>(malloc(strlen(inNewValue->u.str->strData)+1));
+				strcpy(info->mCode, inNewValue->u.str->strData);
+			}
+			findFunc = true;
+			break;
+			
 		case kInputGetArgs:
 		{
+			if (info->mDiscoveryTicks > 0)
+				DiscoverPythonFunc(ip, inActorInfo);
+			
 			ClearArgInputProperties(ip, inActorInfo);
 			AddArgInputProperties(ip, inActorInfo);
+			
+			// The new inputs have their initial values
+			ResetArgTuple(info);
 			break;
 		}
+		
+		case kInputAutoReload:
+			info->mAutoReload = (inNewValue->u.ivalue != 0);
+			break;
 			
-		default:
+		case kInputAsync:
+			info->mAsync = (inNewValue->u.ivalue != 0);
+			break;
+			
+		case kInputProcess:
+			info->mProcess = (inNewValue->u.ivalue != 0);
+			findFunc = true;
+			break;
+
+		case kInputStream:
+			info->mStreamMode = inNewValue->u.ivalue;
+			findFunc = true;
+			break;
+
+		case kInputMap:
+			info->mMap = (inNewValue->u.ivalue != 0);
+			findFunc = true;
+			break;
+
+		case kInputSeparator:
+			if (inNewValue->u.str != NULL && strlen(inNewValue->u.str->strData) > 0)
+				snprintf(info->mSeparator, sizeof(info->mSeparator), "%s", inNewValue->u.str->strData);
+			else
+				strcpy(info->mSeparator, ",");
+			ClearResultCache(&info->mCache);
+			break;
+
+		case kInputNext:
+			if (info->mStreamMode != 0)
+				PullStream(ip, inActorInfo);
+			break;
+
+		case kInputTimeout:
+			info->mTimeout = (inNewValue->u.ivalue > 0) ? inNewValue->u.ivalue : 0;
+			info->mOverruns = 0;
+			OutputOverruns(ip, inActorInfo);
+			break;
+
+		case kInputBatch:
+			info->mBatch = (inNewValue->u.ivalue != 0);
+			if (!info->mBatch)
+				info->mBatchPending = false;
+			break;
+
+		case kInputCache:
+			ClearResultCache(&info->mCache);
+			info->mCache.size = (inNewValue->u.ivalue > 0) ? inNewValue->u.ivalue : 0;
+			break;
+
+		case kInputStats:
+			info->mStatsOn = (inNewValue->u.ivalue != 0);
+			memset(&info->mStats, 0, sizeof(CallStats));
+			info->mStats.rateStart = GetSeconds();
+			break;
+
+		case kInputWriteTrace:
 		{
+			char path[1024];
+			GetTracePath(path, sizeof(path));
+			if (!WriteTraceFile(path))
+				OutputPythonError(ip, inActorInfo, "could not write the trace file");
+			break;
+		}
+
+		case kInputOutputType:
+			info->mOutputType = inNewValue->u.ivalue;
+			UpdateResultType(ip, inActorInfo);
+			break;
+
+		case kInputInterpreter:
+		{
+			if (inNewValue->u.ivalue == info->mInterpreter->group)
+				break;
+
+			// Load the module again in the interpreter of the new group. The new
+			// interpreter is acquired first, so python is not finalized in between.
+			ClearWatchedFiles(info);
+			ReleasePythonObjects(info);
+			PythonInterpreter *interp = info->mInterpreter;
+			info->mInterpreter = AcquirePythonInterpreter(inNewValue->u.ivalue);
+			ReleasePythonInterpreter(interp);
+
+			info->mAsyncCall = NewAsyncCall();
+			DiscoverPythonFunc(ip, inActorInfo);
+			break;
+		}
 
+		default:
+		{
+			// Convert the argument again on the next call
+			UInt32 arg = inPropertyIndex1 - kInputArg0;
+			if (inPropertyIndex1 >= kInputArg0 && arg < info->mNumArgs)
+				info->mArgs[arg].dirty = true;
 		}
 	}
 
 	if (findFunc)
 	{
-		FindPythonFunc(ip, info);
-				
-		// Output a boolean showing if the function was found
-		Value fv;
-		fv.type = kBoolean;
-		fv.u.ivalue = info->mFuncFound;
-		SetOutputPropertyValue_(ip, inActorInfo, kOutputFuncFound, &fv);
+		// While the scene is active the name is probably being typed, so wait
+		// for it to settle before importing anything
+		if (!inInitializing && info->mMessageReceiver != NULL)
+			info->mDiscoveryTicks = kDiscoveryDelayTicks;
+		else
+			DiscoverPythonFunc(ip, inActorInfo);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReceiveMessage
+// ---------------------------------------------------------------------------------
+// Called on every video frame clock tick while the actor is active. Delivers the
+// results of asynchronous calls, looks up the function once a changed name has
+// settled, and periodically checks the source files of the module, reloading the
+// module and function when they have changed.
+
+static void
+ReceiveMessage(
+	IsadoraParameters*	ip,
+	MessageMask			/* inMessageMask */,
+	PluginMessageInfo*	/* inMessageInfo */,
+	MessageRefCon		inRefCon)
+{
+	ActorInfo* actorInfo = static_cast<ActorInfo*>(inRefCon);
+	PluginInfo* info = GetPluginInfo_(actorInfo);
+	
+	DeliverAsyncResult(ip, actorInfo);
+	
+	if (info->mStreamMode == 1)
+		PullStream(ip, actorInfo);
+	
+	if (info->mStatsOn)
+		OutputCallRate(ip, actorInfo);
+	
+	if (info->mDiscoveryTicks > 0 && --info->mDiscoveryTicks == 0)
+		DiscoverPythonFunc(ip, actorInfo);
+	
+	if (!info->mAutoReload || info->mNumWatchedFiles == 0)
+		return;
+	
+	if (++info->mWatchTicks < kWatchIntervalTicks)
+		return;
+	info->mWatchTicks = 0;
+	
+	if (!WatchedFilesChanged(info))
+		return;
+	
+	// Make sure the module is executed again on import
+	if (info->mPyModule != NULL)
+	{
+		PyGILState_STATE gstate = EnterPythonInterpreter(info->mInterpreter);
+		UnloadPythonModule(info->mPyModule);
+		LeavePythonInterpreter(info->mInterpreter, gstate);
+	}
+	
+	FindPythonFunc(ip, info);
+	
+	Value fv;
+	fv.type = kBoolean;
+	fv.u.ivalue = info->mFuncFound;
+	SetOutputPropertyValue_(ip, actorInfo, kOutputFuncFound, &fv);
+	
+	if (info->mFuncFound)
+	{
+		fv.u.ivalue = 1;
+		SetOutputPropertyValue_(ip, actorInfo, kOutputReloaded, &fv);
 	}
 }
 
@@ -987,7 +6241,7 @@ static void AddArgInputProperties(
 					
 		while (delta-- > 0)
 		{
-			valueInit = *info->mArgs[count]->value;
+			valueInit = info->mArgs[count].value;
 			valueMin.type = valueInit.type;
 			valueMax.type = valueInit.type;
 			// Here we have to check to see what type the input is
@@ -1020,16 +6274,17 @@ static void AddArgInputProperties(
 			}
 						
 			int index = changeableOutputCount + 1;
+			int id = kArg0PropertyID + (index - kInputArg0);
 						
-			OSType rateType = CreatePropertyID(ip, "in", index);
+			OSType rateType = CreatePropertyID(ip, "in", id);
 						
-			PropIDT code = CreatePropertyID(ip, "in", index);
+			PropIDT code = CreatePropertyID(ip, "in", id);
 						
 			err = AddProperty_(ip, inActorInfo,
 								kInputProperty,
 								rateType,					// the input type
 								FOUR_CHAR_CODE(code),		// the input to which we will conform
-								info->mArgs[index-kInputArg0]->name,
+								info->mArgs[index-kInputArg0].name,
 								availFmts,
 								curFmt,
 								1,
@@ -1,3 +1,4 @@
 // Microsoft Visual C++ generated include file.
 // Used by PythonPlugin.rc
 //
+#define IDR_WORKER_PROCESS              101
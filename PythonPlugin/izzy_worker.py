@@ -0,0 +1,285 @@
+"""Worker processes for the process input of the Python plugin.
+
+The plugin runs this module in each interpreter as _izzy_worker, and creates a
+WorkerProcess for the function of each actor in the process mode. The worker
+process runs this same source as its main script, with the path, module and
+function as arguments: it imports the module, reports the arguments, annotations
+and source files of the function, and then calls it for each call it receives.
+The arguments and results are pickled, and sent over the standard input and
+output of the process, prefixed by their length.
+"""
+
+import os, sys, struct, pickle, subprocess, threading
+
+# The source of this module, set by the plugin before it runs it
+SOURCE = None
+
+
+# -------------------------------------------------------------------------------
+# The worker process
+# -------------------------------------------------------------------------------
+
+def name(annotation):
+    return annotation.__name__ if isinstance(annotation, type) else str(annotation)
+
+
+def encode(annotation):
+    """Converts an annotation to plain data, from which annotation() rebuilds it."""
+    if isinstance(annotation, type) and issubclass(annotation, tuple) and hasattr(annotation, '_fields'):
+        types = getattr(annotation, '__annotations__', {})
+        return ('namedtuple', [(field, name(types.get(field))) for field in annotation._fields])
+    if isinstance(annotation, type) and issubclass(annotation, dict) and hasattr(annotation, '__total__'):
+        return ('dict', [(key, name(value)) for key, value in annotation.__annotations__.items()])
+    if isinstance(getattr(annotation, '__args__', None), tuple):
+        origin = getattr(annotation, '__origin__', None)
+        return ('generic', origin is tuple or str(origin) == 'typing.Tuple',
+                [None if arg is Ellipsis else encode(arg) for arg in annotation.__args__])
+    return name(annotation)
+
+
+def basic(value):
+    if value is None or isinstance(value, (bool, int, float, str, type(u''), type(2**64))):
+        return value
+    return str(value)
+
+
+def describe(func):
+    """Returns the arguments, defaults and annotations of a function, and its kind."""
+    signature, skip, kind = func, 0, 'plain'
+    if isinstance(func, type):
+        if not any('__call__' in vars(base) for base in func.__mro__):
+            signature = None
+        else:
+            signature, skip, kind = func.__call__, 1, 'class'
+    signature = getattr(signature, '__func__', signature)
+    code = getattr(signature, '__code__', None)
+    count = code.co_argcount if code is not None else skip
+    names = code.co_varnames if code is not None else ()
+    kwnames = names[count:count + getattr(code, 'co_kwonlyargcount', 0)]
+    defaults = tuple(basic(value) for value in getattr(signature, '__defaults__', None) or ())
+    if kind == 'plain' and code is not None and (code.co_flags & 0x20) != 0:
+        kind = 'generator'
+    return {
+        'kind': kind,
+        'args': list(names[skip:count]),
+        'kwargs': list(kwnames),
+        'defaults': defaults[max(len(defaults) - (count - skip), 0):],
+        'kwdefaults': dict((key, basic(value)) for key, value in (getattr(signature, '__kwdefaults__', None) or {}).items()),
+        'annotations': dict((key, encode(value)) for key, value in (getattr(signature, '__annotations__', None) or {}).items()),
+    }
+
+
+def serve(path, module, function):
+    """The main loop of the worker process."""
+    out = os.fdopen(os.dup(1), 'wb')
+    os.dup2(2, 1)
+    inp = getattr(sys.stdin, 'buffer', sys.stdin)
+
+    def read(size):
+        data = inp.read(size)
+        if len(data) < size:
+            sys.exit(0)
+        return data
+
+    def write(ok, value):
+        data = pickle.dumps((ok, value), 2)
+        out.write(struct.pack('<I', len(data)) + data)
+        out.flush()
+
+    try:
+        if path:
+            sys.path.insert(0, path)
+        func = getattr(__import__(module, fromlist=['_']), function)
+        if not callable(func):
+            raise TypeError('%s is not callable' % function)
+        description = describe(func)
+        top = module.split('.')[0]
+        description['files'] = [value.__file__ for key, value in list(sys.modules.items())
+                                if (key == top or key.startswith(top + '.')) and getattr(value, '__file__', None)]
+    except Exception as e:
+        write(False, '%s: %s' % (type(e).__name__, e))
+        sys.exit(0)
+    write(True, description)
+
+    kind, state = description['kind'], None
+    while True:
+        args, kwargs = pickle.loads(read(struct.unpack('<I', read(4))[0]))
+        try:
+            if kind == 'class':
+                if state is None:
+                    state = func()
+                value = state(*args, **kwargs)
+            elif kind == 'generator':
+                try:
+                    if state is None:
+                        state = func(*args, **kwargs)
+                        value = next(state)
+                    else:
+                        value = state.send(args)
+                except StopIteration:
+                    state = None
+                    raise StopIteration('the generator has finished')
+            else:
+                value = func(*args, **kwargs)
+            if isinstance(value, tuple):
+                value = tuple(value)
+            elif isinstance(value, dict):
+                value = dict(value)
+            result = (True, value)
+        except Exception as e:
+            result = (False, str(e))
+        write(*result)
+
+
+# -------------------------------------------------------------------------------
+# The plugin side
+# -------------------------------------------------------------------------------
+
+def python_executable():
+    path = os.environ.get('IZZY_PYTHON_EXECUTABLE')
+    if path:
+        return path
+    if os.name == 'nt':
+        paths = [os.path.join(sys.exec_prefix, 'python.exe')]
+    else:
+        paths = [os.path.join(sys.exec_prefix, 'bin', 'python%d.%d' % sys.version_info[:2]),
+                 os.path.join(sys.exec_prefix, 'bin', 'python%d' % sys.version_info[0])]
+    if os.path.basename(sys.executable or '').lower().startswith('python'):
+        paths.insert(0, sys.executable)
+    for path in paths:
+        if os.path.isfile(path):
+            return path
+    raise RuntimeError('python executable not found; set IZZY_PYTHON_EXECUTABLE')
+
+
+class Annotation(object):
+    def __init__(self, origin, args):
+        self.__origin__ = origin
+        self.__args__ = args
+
+
+def annotation(value):
+    """Rebuilds an annotation encoded by encode(), as far as the plugin reads it."""
+    if value is None:
+        return Ellipsis
+    if not isinstance(value, tuple):
+        return value
+    if value[0] == 'namedtuple':
+        return type('Result', (tuple,), {'_fields': tuple(field for field, _ in value[1]), '__annotations__': dict(value[1])})
+    if value[0] == 'dict':
+        return type('Result', (dict,), {'__annotations__': dict(value[1]), '__total__': True})
+    return Annotation(tuple if value[1] else None, tuple(annotation(arg) for arg in value[2]))
+
+
+class WorkerProcess(object):
+    """A callable that calls the function in a worker process.
+
+    start() starts the process and returns a stub function with the signature of
+    the function. When the process has stopped, a call raises an error, and the
+    next call starts it again. kill() stops a call that runs over its time limit.
+    The process is stopped when the WorkerProcess is released.
+    """
+
+    def __init__(self, path, module, function):
+        self.command = ['', '-c', SOURCE, path, module, function]
+        self.process = None
+        self.files = []
+        self.kind = 'plain'
+
+    def start(self, timeout):
+        result = []
+
+        def receive():
+            try:
+                result.append(self.receive())
+            except RuntimeError as e:
+                result.append((False, str(e)))
+
+        self.spawn()
+        thread = threading.Thread(target=receive)
+        thread.daemon = True
+        thread.start()
+        thread.join(timeout)
+        if thread.is_alive():
+            self.kill()
+            thread.join()
+            raise RuntimeError('the worker process did not start within %d seconds' % timeout)
+        ok, description = result[0]
+        if not ok:
+            self.close()
+            raise RuntimeError(description)
+        self.files = description['files']
+        self.kind = description['kind']
+        return self.stub(description)
+
+    def stub(self, description):
+        names = description['args'] + (['*'] + description['kwargs'] if description['kwargs'] else [])
+        namespace = {}
+        body = 'yield' if description['kind'] == 'generator' else 'pass'
+        exec('def stub(%s):\n    %s\n' % (', '.join(names), body), namespace)
+        stub = namespace['stub']
+        stub.__defaults__ = description['defaults'] or None
+        if description['kwargs']:
+            stub.__kwdefaults__ = description['kwdefaults']
+        stub.__annotations__ = dict((key, annotation(value)) for key, value in description['annotations'].items())
+        return stub
+
+    def spawn(self):
+        self.command[0] = python_executable()
+        self.process = subprocess.Popen(self.command, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        creationflags=0x08000000 if os.name == 'nt' else 0)
+
+    def __call__(self, *args, **kwargs):
+        data = pickle.dumps((args, kwargs), 2)
+        if self.process is None:
+            self.spawn()
+            ok, value = self.receive()
+            if not ok:
+                self.close()
+                raise RuntimeError(value)
+        try:
+            self.process.stdin.write(struct.pack('<I', len(data)) + data)
+            self.process.stdin.flush()
+        except (IOError, OSError):
+            raise RuntimeError('the worker process exited with code %s' % self.close())
+        ok, value = self.receive()
+        if not ok:
+            raise RuntimeError(value)
+        return value
+
+    def receive(self):
+        try:
+            return pickle.loads(self.read(struct.unpack('<I', self.read(4))[0]))
+        except (IOError, OSError, EOFError):
+            raise RuntimeError('the worker process exited with code %s' % self.close())
+
+    def read(self, size):
+        data = self.process.stdout.read(size)
+        if len(data) < size:
+            raise EOFError()
+        return data
+
+    def kill(self):
+        process = self.process
+        if process is not None:
+            try:
+                process.kill()
+            except OSError:
+                pass
+
+    def close(self):
+        process, self.process = self.process, None
+        if process is None:
+            return None
+        process.stdin.close()
+        process.stdout.close()
+        if process.poll() is None:
+            process.kill()
+        return process.wait()
+
+    def __del__(self):
+        self.close()
+
+
+if __name__ == '__main__':
+    serve(*sys.argv[1:4])
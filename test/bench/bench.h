@@ -0,0 +1,44 @@
+// =================================================================================
+//	Benchmark helpers
+// =================================================================================
+
+#ifndef IZZY_BENCH_BENCH_H
+#define IZZY_BENCH_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+// Prints the median, 99th percentile and throughput of a series of durations in
+// seconds, as one line of the benchmark report.
+static void
+ReportLatencies(
+	const char*				inName,
+	std::vector<double>		inDurations)
+{
+	if (inDurations.empty())
+		return;
+
+	double total = 0;
+	for (size_t i=0; i<inDurations.size(); i++)
+		total += inDurations[i];
+	std::sort(inDurations.begin(), inDurations.end());
+
+	double p50 = inDurations[inDurations.size() / 2];
+	double p99 = inDurations[std::min(inDurations.size() - 1, inDurations.size() * 99 / 100)];
+	printf("%-32s p50 %9.2f us   p99 %9.2f us   %10.0f calls/s\n", inName, p50 * 1e6, p99 * 1e6, inDurations.size() / total);
+}
+
+// Returns the number of iterations from the first command line argument.
+static int
+Iterations(
+	int		argc,
+	char**	argv,
+	int		inDefault)
+{
+	return (argc > 1) ? atoi(argv[1]) : inDefault;
+}
+
+#endif
@@ -0,0 +1,79 @@
+// =================================================================================
+//	Argument conversion
+// =================================================================================
+//
+//	Measures the latency of triggering functions with 1, 4 and 16 arguments, with
+//	the argument values unchanged between triggers and with all of them changed.
+//
+//	Usage: bench_args [iterations]
+
+#include "host.h"
+#include "bench.h"
+
+static void
+RunArgs(
+	const char*		inFunc,
+	int				inNumArgs,
+	bool			inChange,
+	int				inIterations)
+{
+	static const char *names[] = { "a", "b", "c", "d" };
+
+	ActorInfo *actor = HostCreateActor();
+	HostSetString(actor, "path", BENCH_MODULES_DIR);
+	HostSetString(actor, "module", "benchargs");
+	HostSetString(actor, "function", inFunc);
+	HostTrigger(actor, "get_args");
+
+	for (int i=0; i<100; i++)
+		HostTrigger(actor, "trigger");
+
+	std::vector<double> durations;
+	durations.reserve(inIterations);
+	for (int i=0; i<inIterations; i++)
+	{
+		// The arguments cycle through the types int, float, str and bool
+		if (inChange)
+		{
+			for (int k=0; k<inNumArgs; k++)
+			{
+				char name[8], str[16];
+				snprintf(name, sizeof(name), "%s%d", names[k % 4], k / 4);
+				switch (k % 4)
+				{
+					case 0:	HostSetInt(actor, name, i);					break;
+					case 1:	HostSetFloat(actor, name, (float) i);		break;
+					case 2:	snprintf(str, sizeof(str), "s%d", i & 7);
+							HostSetString(actor, name, str);			break;
+					case 3:	HostSetBool(actor, name, (i & 1) != 0);	break;
+				}
+			}
+		}
+
+		double start = HostSeconds();
+		HostTrigger(actor, "trigger");
+		durations.push_back(HostSeconds() - start);
+	}
+
+	char label[64];
+	snprintf(label, sizeof(label), "%d args, %s", inNumArgs, inChange ? "changed" : "unchanged");
+	ReportLatencies(label, durations);
+
+	HostDisposeActor(actor);
+}
+
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	int iterations = Iterations(argc, argv, 200000);
+
+	RunArgs("f1", 1, false, iterations);
+	RunArgs("f4", 4, false, iterations);
+	RunArgs("f16", 16, false, iterations);
+	RunArgs("f1", 1, true, iterations);
+	RunArgs("f4", 4, true, iterations);
+	RunArgs("f16", 16, true, iterations);
+	return 0;
+}
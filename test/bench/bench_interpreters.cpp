@@ -0,0 +1,113 @@
+// =================================================================================
+//	Throughput of asynchronous actors in separate interpreters
+// =================================================================================
+//
+//	Calls spin in modules/spin.py from 1, 2, 4 and 8 asynchronous actors at once,
+//	each in its own interpreter group, and reports the calls per second of all of
+//	them together. With Python 3.12 or newer every group has its own GIL, so the
+//	throughput should grow with the number of actors, up to the number of
+//	processors; with an older Python all groups share the main interpreter. On a
+//	free-threaded build that runs without the GIL, the same actors are also run
+//	in interpreter 0, where they share one interpreter and its worker threads.
+//
+//	Usage: bench_interpreters [calls per actor]
+
+#include "host.h"
+#include "bench.h"
+
+#include <unistd.h>
+
+// Triggers every actor inCalls times, each again as soon as its previous call
+// ran, and returns the total number of calls per second. Returns 0 if a call
+// did not return the expected result.
+static double
+RunActors(
+	std::vector<ActorInfo*>&	inActors,
+	int							inCalls)
+{
+	std::vector<unsigned int> ran(inActors.size());
+	std::vector<int> left(inActors.size(), inCalls);
+	for (size_t i=0; i<inActors.size(); i++)
+	{
+		ran[i] = HostOutputCount(inActors[i], "function_ran");
+		HostTrigger(inActors[i], "trigger");
+	}
+
+	double start = HostSeconds();
+	size_t busy = inActors.size();
+	while (busy > 0 && HostSeconds() - start < 60)
+	{
+		usleep(100);
+		HostTick();
+		for (size_t i=0; i<inActors.size(); i++)
+		{
+			if (left[i] == 0 || HostOutputCount(inActors[i], "function_ran") == ran[i])
+				continue;
+			ran[i] = HostOutputCount(inActors[i], "function_ran");
+			if (--left[i] > 0)
+				HostTrigger(inActors[i], "trigger");
+			else
+				busy--;
+		}
+	}
+	double duration = HostSeconds() - start;
+
+	for (size_t i=0; i<inActors.size(); i++)
+	{
+		if (HostOutputNumber(inActors[i], "value") != 70000)
+		{
+			fprintf(stderr, "unexpected result of spin: %s\n", HostOutputString(inActors[i], "error"));
+			return 0;
+		}
+	}
+	return busy > 0 ? 0 : inActors.size() * inCalls / duration;
+}
+
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	int calls = Iterations(argc, argv, 200);
+	const int counts[] = { 1, 2, 4, 8 };
+	bool ok = true;
+
+	ActorInfo *actor = HostCreateActor();
+	HostSetString(actor, "path", BENCH_MODULES_DIR);
+	HostSetString(actor, "module", "spin");
+	HostSetString(actor, "function", "gil_enabled");
+	HostTrigger(actor, "trigger");
+	bool shared = (HostOutputNumber(actor, "value") == 0);
+	HostDisposeActor(actor);
+
+	for (size_t n=0; n<(shared ? 2 : 1) * sizeof(counts)/sizeof(counts[0]); n++)
+	{
+		size_t c = n % (sizeof(counts)/sizeof(counts[0]));
+		bool inShared = (n != c);
+		std::vector<ActorInfo*> actors;
+		for (int i=0; i<counts[c]; i++)
+		{
+			ActorInfo *actor = HostCreateActor();
+			HostSetString(actor, "path", BENCH_MODULES_DIR);
+			HostSetString(actor, "module", "spin");
+			HostSetString(actor, "function", "spin");
+			HostSetInt(actor, "interpreter", inShared ? 0 : i + 1);
+			HostSetBool(actor, "async", true);
+			HostTrigger(actor, "get_args");
+			actors.push_back(actor);
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "%d actors, %d interpreters", counts[c], inShared ? 1 : counts[c]);
+		double rate = RunActors(actors, calls);
+		printf("%-32s %10.0f calls/s\n", name, rate);
+		ok = ok && (rate > 0);
+
+		for (size_t i=actors.size(); i>0; i--)
+			HostDisposeActor(actors[i-1]);
+	}
+
+	if (!shared)
+		printf("%-32s skipped, the GIL is enabled\n", "actors in 1 interpreter");
+	return ok ? 0 : 1;
+}
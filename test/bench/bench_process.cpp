@@ -0,0 +1,53 @@
+// =================================================================================
+//	Worker process round trip
+// =================================================================================
+//
+//	Compares the latency of calling a function in the embedded interpreter with
+//	calling it in a worker process, using the process input.
+//
+//	Usage: bench_process [iterations]
+
+#include "host.h"
+#include "bench.h"
+
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	int iterations = Iterations(argc, argv, 20000);
+	bool ok = true;
+
+	ActorInfo *actor = HostCreateActor();
+	HostSetString(actor, "path", BENCH_MODULES_DIR);
+	HostSetString(actor, "module", "worker");
+	HostSetString(actor, "function", "double");
+
+	for (int process=0; process<2; process++)
+	{
+		HostSetBool(actor, "process", process != 0);
+		HostTrigger(actor, "get_args");
+		HostSetInt(actor, "x", 21);
+
+		for (int i=0; i<100; i++)
+			HostTrigger(actor, "trigger");
+
+		std::vector<double> durations;
+		durations.reserve(iterations);
+		for (int i=0; i<iterations; i++)
+		{
+			double start = HostSeconds();
+			HostTrigger(actor, "trigger");
+			durations.push_back(HostSeconds() - start);
+		}
+		ReportLatencies(process ? "worker process" : "in process", durations);
+
+		ok = ok && (HostOutputNumber(actor, "value") == 42);
+	}
+
+	HostDisposeActor(actor);
+
+	if (!ok)
+		fprintf(stderr, "unexpected result of double\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+// =================================================================================
+//	Discovery and trigger latency of the example module
+// =================================================================================
+//
+//	Measures how long it takes to discover test1 in test/example/example.py and add
+//	its argument inputs, for many actors, and the latency and throughput of
+//	triggering test2.
+//
+//	Usage: bench_trigger [iterations]
+
+#include "host.h"
+#include "bench.h"
+
+#include <string.h>
+
+int
+main(
+	int		argc,
+	char**	argv)
+{
+	int iterations = Iterations(argc, argv, 20000);
+	const int numActors = 200;
+
+	// Discovery, including get_args
+	std::vector<ActorInfo*> actors;
+	double start = HostSeconds();
+	for (int i=0; i<numActors; i++)
+	{
+		ActorInfo *actor = HostCreateActor();
+		HostSetString(actor, "path", EXAMPLE_DIR);
+		HostSetString(actor, "module", "example");
+		HostSetString(actor, "function", "test1");
+		HostTrigger(actor, "get_args");
+		actors.push_back(actor);
+	}
+	printf("%-32s %9.2f us per actor\n", "discovery", (HostSeconds() - start) * 1e6 / numActors);
+	for (int i=numActors; i>0; i--)
+		HostDisposeActor(actors[i-1]);
+
+	// Triggers
+	ActorInfo *actor = HostCreateActor();
+	HostSetString(actor, "path", EXAMPLE_DIR);
+	HostSetString(actor, "module", "example");
+	HostSetString(actor, "function", "test2");
+	HostTrigger(actor, "get_args");
+	HostSetString(actor, "string", "abc");
+	HostSetInt(actor, "times", 2);
+
+	for (int i=0; i<100; i++)
+		HostTrigger(actor, "trigger");
+
+	std::vector<double> durations;
+	durations.reserve(iterations);
+	for (int i=0; i<iterations; i++)
+	{
+		double callStart = HostSeconds();
+		HostTrigger(actor, "trigger");
+		durations.push_back(HostSeconds() - callStart);
+		HostTick();
+	}
+	ReportLatencies("trigger test2", durations);
+
+	bool ok = (strcmp(HostOutputString(actor, "output"), "abcabc") == 0);
+	HostDisposeActor(actor);
+
+	if (!ok)
+		fprintf(stderr, "unexpected output of test2\n");
+	return ok ? 0 : 1;
+}
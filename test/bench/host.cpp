@@ -0,0 +1,485 @@
+// =================================================================================
+//	Stand-in Isadora host
+// =================================================================================
+//
+//	Implements the Isadora callbacks declared in sdk/IsadoraCallbacks.h for the
+//	actors created by HostCreateActor. See host.h.
+
+#include "host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" void GetActorInfo(void* inParam, ActorInfo* outActorParams);
+
+bool gHostVerbose = false;
+
+struct HostProperty {
+	std::string			name;
+	Value				value;
+	unsigned int		count;		// number of times the output was set
+};
+
+struct HostActor {
+	std::vector<HostProperty>	inputs;
+	std::vector<HostProperty>	outputs;
+};
+
+struct HostReceiver {
+	MessageReceiveFunction	function;
+	MessageRefCon			refCon;
+};
+
+static IsadoraParameters					sParameters;
+static std::map<ActorInfo*, HostActor*>		sActors;
+static std::vector<HostReceiver*>			sReceivers;
+
+// ---------------------------------------------------------------------------------
+//		Helpers
+// ---------------------------------------------------------------------------------
+
+static HostActor*
+FindActor(
+	ActorInfo*	inActor)
+{
+	std::map<ActorInfo*, HostActor*>::iterator it = sActors.find(inActor);
+	if (it == sActors.end())
+	{
+		fprintf(stderr, "host: unknown actor\n");
+		abort();
+	}
+	return it->second;
+}
+
+static Value
+CopyValue(
+	const Value&	inValue)
+{
+	Value value = inValue;
+	if (inValue.type == kString)
+		AllocateValueString_(&sParameters, (inValue.u.str != NULL) ? inValue.u.str->strData : "", &value);
+	return value;
+}
+
+static int
+FindProperty(
+	std::vector<HostProperty>&	inProperties,
+	const char*					inName)
+{
+	for (size_t i = inProperties.size(); i > 0; i--)
+	{
+		if (inProperties[i-1].name == inName)
+			return (int) i;
+	}
+	return 0;
+}
+
+static void
+SetInput(
+	ActorInfo*		inActor,
+	const char*		inName,
+	const Value&	inValue)
+{
+	HostActor *actor = FindActor(inActor);
+	int index = FindProperty(actor->inputs, inName);
+	if (index == 0)
+	{
+		fprintf(stderr, "host: no input named %s\n", inName);
+		abort();
+	}
+
+	Value oldValue = actor->inputs[index-1].value;
+	actor->inputs[index-1].value = CopyValue(inValue);
+	inActor->mHandlePropertyChangeValueProc(&sParameters, inActor, index, &oldValue, &actor->inputs[index-1].value, false);
+	ReleaseValueString_(&sParameters, &oldValue);
+}
+
+// ---------------------------------------------------------------------------------
+//		Host functions
+// ---------------------------------------------------------------------------------
+
+ActorInfo*
+HostCreateActor()
+{
+	ActorInfo *info = new ActorInfo;
+	memset(info, 0, sizeof(ActorInfo));
+	GetActorInfo(NULL, info);
+
+	HostActor *actor = new HostActor;
+	sActors[info] = actor;
+
+	// The fixed inputs and outputs, from the property definition string
+	std::stringstream lines(info->mGetActorParameterStringProc(&sParameters, info));
+	std::string line;
+	while (std::getline(lines, line, '\r'))
+	{
+		std::stringstream fields(line);
+		std::string kind, name, id, type, dispFormat, min, max, init;
+		fields >> kind >> name >> id >> type >> dispFormat >> min >> max >> init;
+
+		HostProperty property;
+		property.name = name;
+		property.count = 0;
+		property.value.type = (type == "string") ? kString : (type == "float") ? kFloat : (type == "bool") ? kBoolean : kInteger;
+		if (property.value.type == kString)
+			AllocateValueString_(&sParameters, init.c_str(), &property.value);
+		else if (property.value.type == kFloat)
+			property.value.u.fvalue = (float) atof(init.c_str());
+		else
+			property.value.u.ivalue = atoi(init.c_str());
+
+		if (kind == "INPROP")
+			actor->inputs.push_back(property);
+		else if (kind == "OUTPROP")
+			actor->outputs.push_back(property);
+	}
+
+	info->mCreateActorProc(&sParameters, info);
+	info->mActivateActorProc(&sParameters, info, true);
+	return info;
+}
+
+void
+HostDisposeActor(
+	ActorInfo*	inActor)
+{
+	HostActor *actor = FindActor(inActor);
+
+	inActor->mActivateActorProc(&sParameters, inActor, false);
+	inActor->mDisposeActorProc(&sParameters, inActor);
+
+	for (size_t i=0; i<actor->inputs.size(); i++)
+		ReleaseValueString_(&sParameters, &actor->inputs[i].value);
+	for (size_t i=0; i<actor->outputs.size(); i++)
+		ReleaseValueString_(&sParameters, &actor->outputs[i].value);
+	sActors.erase(inActor);
+	delete actor;
+	delete inActor;
+}
+
+void
+HostSetString(
+	ActorInfo*	inActor,
+	const char*	inName,
+	const char*	inValue)
+{
+	Value value;
+	AllocateValueString_(&sParameters, inValue, &value);
+	SetInput(inActor, inName, value);
+	ReleaseValueString_(&sParameters, &value);
+}
+
+void
+HostSetInt(
+	ActorInfo*	inActor,
+	const char*	inName,
+	SInt32		inValue)
+{
+	Value value;
+	value.type = kInteger;
+	value.u.ivalue = inValue;
+	SetInput(inActor, inName, value);
+}
+
+void
+HostSetFloat(
+	ActorInfo*	inActor,
+	const char*	inName,
+	float		inValue)
+{
+	Value value;
+	value.type = kFloat;
+	value.u.fvalue = inValue;
+	SetInput(inActor, inName, value);
+}
+
+void
+HostSetBool(
+	ActorInfo*	inActor,
+	const char*	inName,
+	bool		inValue)
+{
+	Value value;
+	value.type = kBoolean;
+	value.u.ivalue = inValue ? 1 : 0;
+	SetInput(inActor, inName, value);
+}
+
+void
+HostTrigger(
+	ActorInfo*	inActor,
+	const char*	inName)
+{
+	HostSetBool(inActor, inName, true);
+}
+
+void
+HostTick()
+{
+	// Receivers may be added or removed while the clock is sent
+	std::vector<HostReceiver*> receivers = sReceivers;
+	for (size_t i=0; i<receivers.size(); i++)
+		receivers[i]->function(&sParameters, kWantVideoFrameTick, NULL, receivers[i]->refCon);
+}
+
+const Value*
+HostOutput(
+	ActorInfo*	inActor,
+	const char*	inName)
+{
+	HostActor *actor = FindActor(inActor);
+	int index = FindProperty(actor->outputs, inName);
+	return (index > 0) ? &actor->outputs[index-1].value : NULL;
+}
+
+const char*
+HostOutputString(
+	ActorInfo*	inActor,
+	const char*	inName)
+{
+	const Value *value = HostOutput(inActor, inName);
+	return (value != NULL && value->type == kString && value->u.str != NULL) ? value->u.str->strData : "";
+}
+
+double
+HostOutputNumber(
+	ActorInfo*	inActor,
+	const char*	inName)
+{
+	const Value *value = HostOutput(inActor, inName);
+	if (value == NULL || value->type == kString)
+		return 0;
+	return (value->type == kFloat) ? value->u.fvalue : value->u.ivalue;
+}
+
+unsigned int
+HostOutputCount(
+	ActorInfo*	inActor,
+	const char*	inName)
+{
+	HostActor *actor = FindActor(inActor);
+	int index = FindProperty(actor->outputs, inName);
+	return (index > 0) ? actor->outputs[index-1].count : 0;
+}
+
+double
+HostSeconds()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// ---------------------------------------------------------------------------------
+//		Isadora callbacks
+// ---------------------------------------------------------------------------------
+
+void*
+IzzyMallocClear_(
+	IsadoraParameters*	/* ip */,
+	size_t				inSize)
+{
+	return calloc(1, inSize);
+}
+
+void
+IzzyFree_(
+	IsadoraParameters*	/* ip */,
+	void*				inPtr)
+{
+	free(inPtr);
+}
+
+void
+PluginAssert_(
+	IsadoraParameters*	/* ip */,
+	bool				inCondition)
+{
+	if (!inCondition)
+	{
+		fprintf(stderr, "host: plugin assertion failed\n");
+		abort();
+	}
+}
+
+void
+AllocateValueString_(
+	IsadoraParameters*	/* ip */,
+	const char*			inString,
+	Value*				outValue)
+{
+	if (inString == NULL)
+		inString = "";
+	size_t length = strlen(inString);
+	outValue->type = kString;
+	outValue->u.str = (ValueString*) malloc(sizeof(ValueString) + length);
+	outValue->u.str->strLen = (UInt32) length;
+	memcpy(outValue->u.str->strData, inString, length + 1);
+}
+
+void
+ReleaseValueString_(
+	IsadoraParameters*	/* ip */,
+	Value*				ioValue)
+{
+	if (ioValue->type == kString && ioValue->u.str != NULL)
+	{
+		free(ioValue->u.str);
+		ioValue->u.str = NULL;
+	}
+}
+
+Value*
+GetInputPropertyValue_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			inActorInfo,
+	PropertyIndex		inIndex)
+{
+	return &FindActor(inActorInfo)->inputs[inIndex-1].value;
+}
+
+void
+SetOutputPropertyValue_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			inActorInfo,
+	PropertyIndex		inIndex,
+	Value*				inValue)
+{
+	HostProperty &output = FindActor(inActorInfo)->outputs[inIndex-1];
+	ReleaseValueString_(&sParameters, &output.value);
+	output.value = CopyValue(*inValue);
+	output.count++;
+
+	if (!gHostVerbose)
+		return;
+	if (inValue->type == kString)
+		printf("  %s = \"%s\"\n", output.name.c_str(), inValue->u.str->strData);
+	else if (inValue->type == kFloat)
+		printf("  %s = %g\n", output.name.c_str(), inValue->u.fvalue);
+	else
+		printf("  %s = %d\n", output.name.c_str(), (int) inValue->u.ivalue);
+}
+
+IzzyError
+GetPropertyCount_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			inActorInfo,
+	PropertyType		inType,
+	UInt32*				outCount)
+{
+	HostActor *actor = FindActor(inActorInfo);
+	*outCount = (UInt32) ((inType == kInputProperty) ? actor->inputs.size() : actor->outputs.size());
+	return kIzzyNoError;
+}
+
+UInt32
+PropertyTypeAndIndexToHelpIndex_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	PropertyType		/* inType */,
+	PropertyIndex		inIndex)
+{
+	return inIndex;
+}
+
+void
+GetPropertyMinMax_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	PropertyType		/* inType */,
+	PropertyIndex		/* inIndex */,
+	Value*				/* outMin */,
+	Value*				/* outMax */,
+	void*				/* outInit */)
+{
+}
+
+IzzyError
+AddProperty_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			inActorInfo,
+	PropertyType		inType,
+	OSType				/* inRateType */,
+	PropIDT				/* inID */,
+	const char*			inName,
+	PropertyDispFormat	/* inAvailFormats */,
+	PropertyDispFormat	/* inFormat */,
+	int					/* inCount */,
+	Value*				/* inMin */,
+	Value*				/* inMax */,
+	Value*				inInit)
+{
+	HostActor *actor = FindActor(inActorInfo);
+
+	HostProperty property;
+	property.name = inName;
+	property.value = CopyValue(*inInit);
+	property.count = 0;
+	if (inType == kInputProperty)
+		actor->inputs.push_back(property);
+	else
+		actor->outputs.push_back(property);
+	return kIzzyNoError;
+}
+
+void
+CopyPropDefValueSource_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	PropertyType		/* inSrcType */,
+	PropertyIndex		/* inSrcIndex */,
+	PropertyType		/* inDstType */,
+	PropertyIndex		/* inDstIndex */)
+{
+}
+
+IzzyError
+RemovePropertyProc_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			inActorInfo,
+	PropertyType		inType,
+	PropertyIndex		inIndex)
+{
+	HostActor *actor = FindActor(inActorInfo);
+	std::vector<HostProperty> &properties = (inType == kInputProperty) ? actor->inputs : actor->outputs;
+	ReleaseValueString_(&sParameters, &properties[inIndex-1].value);
+	properties.erase(properties.begin() + (inIndex - 1));
+	return kIzzyNoError;
+}
+
+MessageReceiverRef
+CreateMessageReceiver_(
+	IsadoraParameters*		/* ip */,
+	MessageReceiveFunction	inFunction,
+	MessageMask				/* inMask */,
+	MessageRefCon			inRefCon)
+{
+	HostReceiver *receiver = new HostReceiver;
+	receiver->function = inFunction;
+	receiver->refCon = inRefCon;
+	sReceivers.push_back(receiver);
+	return receiver;
+}
+
+void
+DisposeMessageReceiver_(
+	IsadoraParameters*	/* ip */,
+	MessageReceiverRef	inReceiver)
+{
+	for (size_t i=0; i<sReceivers.size(); i++)
+	{
+		if (sReceivers[i] == inReceiver)
+		{
+			sReceivers.erase(sReceivers.begin() + i);
+			delete (HostReceiver*) inReceiver;
+			return;
+		}
+	}
+}
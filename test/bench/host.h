@@ -0,0 +1,42 @@
+// =================================================================================
+//	Stand-in Isadora host
+// =================================================================================
+//
+//	Creates actors of the plugin, changes their inputs and sends them the video
+//	frame clock, the way Isadora does, so the plugin can be tested and benchmarked
+//	outside of Isadora. Inputs and outputs are referred to by their name; the
+//	inputs added for the arguments of a function take precedence over the fixed
+//	inputs with the same name.
+
+#ifndef IZZY_BENCH_HOST_H
+#define IZZY_BENCH_HOST_H
+
+#include "IsadoraCallbacks.h"
+
+// When true, every change of an output is printed to stdout
+extern bool gHostVerbose;
+
+ActorInfo*		HostCreateActor();
+void			HostDisposeActor(ActorInfo* inActor);
+
+void			HostSetString(ActorInfo* inActor, const char* inName, const char* inValue);
+void			HostSetInt(ActorInfo* inActor, const char* inName, SInt32 inValue);
+void			HostSetFloat(ActorInfo* inActor, const char* inName, float inValue);
+void			HostSetBool(ActorInfo* inActor, const char* inName, bool inValue);
+void			HostTrigger(ActorInfo* inActor, const char* inName);
+
+// Sends one tick of the video frame clock to all actors
+void			HostTick();
+
+// Returns the current value of an output, or NULL if there is no such output
+const Value*	HostOutput(ActorInfo* inActor, const char* inName);
+const char*		HostOutputString(ActorInfo* inActor, const char* inName);
+double			HostOutputNumber(ActorInfo* inActor, const char* inName);
+
+// Returns the number of times an output was set, eg to count triggers
+unsigned int	HostOutputCount(ActorInfo* inActor, const char* inName);
+
+// Returns the number of seconds on a monotonic clock
+double			HostSeconds();
+
+#endif
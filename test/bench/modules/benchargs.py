@@ -0,0 +1,12 @@
+"""Functions with 1, 4 and 16 arguments of the types int, float, str and bool,
+for bench_args."""
+
+def f1(a0=1):
+    return a0
+
+def f4(a0=1, b0=1.0, c0="s", d0=True):
+    return a0
+
+def f16(a0=1, b0=1.0, c0="s", d0=True, a1=1, b1=1.0, c1="s", d1=True,
+        a2=1, b2=1.0, c2="s", d2=True, a3=1, b3=1.0, c3="s", d3=True):
+    return a0
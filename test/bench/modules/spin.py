@@ -0,0 +1,13 @@
+"""A function that keeps the interpreter busy, for bench_interpreters."""
+
+def spin(n: int = 20000) -> int:
+    total = 0
+    for i in range(n):
+        total += i & 7
+    return total
+
+
+def gil_enabled() -> bool:
+    """False on a free-threaded build of python that runs without the GIL."""
+    import sys
+    return getattr(sys, '_is_gil_enabled', lambda: True)()
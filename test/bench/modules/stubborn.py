@@ -0,0 +1,22 @@
+"""Functions that do not end within their time limit, for test_timeout."""
+
+import time
+
+
+def swallow(times: int = 3) -> int:
+    """Keeps running after the first few TimeoutErrors, and returns how many it caught."""
+    caught = 0
+    while True:
+        try:
+            while True:
+                pass
+        except Exception:
+            caught += 1
+            if caught > times:
+                return caught
+
+
+def hang(seconds: float = 60) -> int:
+    """Waits outside of python, as a hanging extension module would."""
+    time.sleep(seconds)
+    return 1
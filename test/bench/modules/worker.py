@@ -0,0 +1,4 @@
+"""A function to call in a worker process, for bench_process."""
+
+def double(x: int = 1) -> int:
+    return x * 2
@@ -0,0 +1,35 @@
+// =================================================================================
+//	Stand-in for the IsadoraCallbacks.h header of the Isadora SDK
+// =================================================================================
+//
+//	Declares the callbacks used by PythonPlugin.cpp as plain functions. They are
+//	implemented by the stand-in host in host.cpp.
+
+#ifndef IZZY_STUB_ISADORACALLBACKS_H
+#define IZZY_STUB_ISADORACALLBACKS_H
+
+#include "IsadoraTypes.h"
+
+typedef void (*MessageReceiveFunction)(IsadoraParameters*, MessageMask, PluginMessageInfo*, MessageRefCon);
+
+void*				IzzyMallocClear_(IsadoraParameters* ip, size_t inSize);
+void				IzzyFree_(IsadoraParameters* ip, void* inPtr);
+void				PluginAssert_(IsadoraParameters* ip, bool inCondition);
+
+void				AllocateValueString_(IsadoraParameters* ip, const char* inString, Value* outValue);
+void				ReleaseValueString_(IsadoraParameters* ip, Value* ioValue);
+
+Value*				GetInputPropertyValue_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyIndex inIndex);
+void				SetOutputPropertyValue_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyIndex inIndex, Value* inValue);
+IzzyError			GetPropertyCount_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inType, UInt32* outCount);
+UInt32				PropertyTypeAndIndexToHelpIndex_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inType, PropertyIndex inIndex);
+void				GetPropertyMinMax_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inType, PropertyIndex inIndex, Value* outMin, Value* outMax, void* outInit);
+IzzyError			AddProperty_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inType, OSType inRateType, PropIDT inID, const char* inName,
+						PropertyDispFormat inAvailFormats, PropertyDispFormat inFormat, int inCount, Value* inMin, Value* inMax, Value* inInit);
+void				CopyPropDefValueSource_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inSrcType, PropertyIndex inSrcIndex, PropertyType inDstType, PropertyIndex inDstIndex);
+IzzyError			RemovePropertyProc_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inType, PropertyIndex inIndex);
+
+MessageReceiverRef	CreateMessageReceiver_(IsadoraParameters* ip, MessageReceiveFunction inFunction, MessageMask inMask, MessageRefCon inRefCon);
+void				DisposeMessageReceiver_(IsadoraParameters* ip, MessageReceiverRef inReceiver);
+
+#endif
@@ -0,0 +1,77 @@
+// =================================================================================
+//	Stand-in for the IsadoraTypes.h header of the Isadora SDK
+// =================================================================================
+//
+//	Declares only the types and constants used by PythonPlugin.cpp, so the plugin
+//	can be compiled and driven by the stand-in host in test/bench on systems
+//	without the SDK. The layout does not match the real SDK.
+
+#ifndef IZZY_STUB_ISADORATYPES_H
+#define IZZY_STUB_ISADORATYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t			UInt32;
+typedef int32_t				SInt32;
+typedef uint32_t			OSType;
+typedef unsigned char		Boolean;
+typedef int32_t				IzzyError;
+typedef uint32_t			PropIDT;
+typedef uint32_t			PropertyIndex;
+typedef uint32_t			MessageMask;
+typedef uint32_t			PropertyDispFormat;
+typedef void*				MessageReceiverRef;
+typedef void*				MessageRefCon;
+
+#define nil					0
+#define noErr				0
+#define kIzzyNoError		0
+#define FOUR_CHAR_CODE(x)	(x)
+
+#define kCurrentIsadoraCallbackVersion	1
+
+enum { kGroupControl = 1 };
+enum { kWantVideoFrameTick = 1 };
+enum { kDisplayFormatText, kDisplayFormatNumber, kDisplayFormatOnOff };
+
+enum PropertyType { kPropertyTypeInvalid, kInputProperty, kOutputProperty };
+enum ValueType { kInteger, kFloat, kBoolean, kString, kData };
+
+struct ValueString {
+	UInt32				strLen;
+	char				strData[1];
+};
+
+struct Value {
+	ValueType			type;
+	union {
+		SInt32			ivalue;
+		float			fvalue;
+		ValueString*	str;
+	} u;
+};
+typedef Value* ValuePtr;
+
+struct IsadoraParameters { int unused; };
+struct PluginMessageInfo { int unused; };
+
+struct ActorInfo {
+	void*				mActorDataPtr;
+	const char*			mActorName;
+	OSType				mClass;
+	OSType				mID;
+	UInt32				mCompatibleWithVersion;
+	const char*			(*mGetActorParameterStringProc)(IsadoraParameters*, ActorInfo*);
+	void				(*mGetActorHelpStringProc)(IsadoraParameters*, ActorInfo*, PropertyType, PropertyIndex, char*, UInt32);
+	void				(*mCreateActorProc)(IsadoraParameters*, ActorInfo*);
+	void				(*mDisposeActorProc)(IsadoraParameters*, ActorInfo*);
+	void				(*mActivateActorProc)(IsadoraParameters*, ActorInfo*, Boolean);
+	void				(*mHandlePropertyChangeValueProc)(IsadoraParameters*, ActorInfo*, PropertyIndex, ValuePtr, ValuePtr, Boolean);
+	void*				mHandlePropertyConnectProc;
+	void*				mGetActorDefinedAreaProc;
+	void*				mDrawActorDefinedAreaProc;
+	void*				mMouseTrackInActorDefinedAreaProc;
+};
+
+#endif
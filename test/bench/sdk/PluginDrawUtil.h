@@ -0,0 +1,5 @@
+// =================================================================================
+//	Stand-in for the PluginDrawUtil.h header of the Isadora SDK
+// =================================================================================
+//
+//	PythonPlugin.cpp does not draw, so nothing is declared here.
@@ -0,0 +1,96 @@
+// =================================================================================
+//	Time limit of a function that catches the TimeoutError
+// =================================================================================
+//
+//	Calls swallow in modules/stubborn.py, which keeps running after it caught the
+//	TimeoutError of the time limit, with and without the async input. The call
+//	must be interrupted again after every time limit, until the function returns.
+//	Then calls hang in a worker process, which must be killed when the time is up
+//	and started again by the next call.
+//
+//	Usage: test_timeout
+
+#include "host.h"
+#include "bench.h"
+
+#include <string.h>
+#include <unistd.h>
+
+int
+main(
+	int		/* argc */,
+	char**	/* argv */)
+{
+	const int timeout = 20;
+	const int times = 3;
+	bool ok = true;
+
+	ActorInfo *actor = HostCreateActor();
+	HostSetString(actor, "path", BENCH_MODULES_DIR);
+	HostSetString(actor, "module", "stubborn");
+	HostSetString(actor, "function", "swallow");
+	HostSetInt(actor, "timeout_ms", timeout);
+	HostTrigger(actor, "get_args");
+	HostSetInt(actor, "times", times);
+
+	for (int async=0; async<2; async++)
+	{
+		HostSetBool(actor, "async", async != 0);
+		unsigned int ran = HostOutputCount(actor, "function_ran");
+
+		double start = HostSeconds();
+		HostTrigger(actor, "trigger");
+		while (HostOutputCount(actor, "function_ran") == ran && HostSeconds() - start < 10)
+		{
+			usleep(1000);
+			HostTick();
+		}
+		double duration = HostSeconds() - start;
+
+		const char *mode = async ? "async" : "sync";
+		printf("%-32s %9.2f ms\n", mode, duration * 1e3);
+		if (HostOutputNumber(actor, "value") != times + 1)
+		{
+			fprintf(stderr, "%s: the function caught %g TimeoutErrors instead of %d\n", mode, HostOutputNumber(actor, "value"), times + 1);
+			ok = false;
+		}
+		if (duration < (times + 1) * timeout / 1e3)
+		{
+			fprintf(stderr, "%s: the function returned before its time limits\n", mode);
+			ok = false;
+		}
+	}
+
+	HostDisposeActor(actor);
+
+	actor = HostCreateActor();
+	HostSetString(actor, "path", BENCH_MODULES_DIR);
+	HostSetString(actor, "module", "stubborn");
+	HostSetString(actor, "function", "hang");
+	HostSetBool(actor, "process", true);
+	HostSetInt(actor, "timeout_ms", timeout);
+	HostTrigger(actor, "get_args");
+
+	double start = HostSeconds();
+	HostTrigger(actor, "trigger");
+	double duration = HostSeconds() - start;
+	printf("%-32s %9.2f ms\n", "process", duration * 1e3);
+	if (strstr(HostOutputString(actor, "error"), "timeout") == NULL || duration > 5)
+	{
+		fprintf(stderr, "process: the call was not stopped by its time limit: %s\n", HostOutputString(actor, "error"));
+		ok = false;
+	}
+
+	// Starting the process may take longer than the time limit
+	HostSetFloat(actor, "seconds", 0);
+	HostSetInt(actor, "timeout_ms", 0);
+	HostTrigger(actor, "trigger");
+	if (HostOutputNumber(actor, "value") != 1)
+	{
+		fprintf(stderr, "process: the next call did not start a new process: %s\n", HostOutputString(actor, "error"));
+		ok = false;
+	}
+
+	HostDisposeActor(actor);
+	return ok ? 0 : 1;
+}
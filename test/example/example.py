@@ -1,6 +1,6 @@
 """Example file to test izzyPythonPlugin.
 In the PythonPlugin actor in Isadora, specify the following:
-    path: the absolute path to the test folder, properly escaped (eg 'C:\\Users\\me\\Desktop\\izzyPythonPlugin\\test')
+    path: the absolute path to the test folder (eg 'C:\\Users\\me\\Desktop\\izzyPythonPlugin\\test')
     module: name of the module, without .py (ie 'example')
     function: name of the function (ie 'test1' or 'test2') 
 """